@@ -0,0 +1,125 @@
+#pragma once
+#include <stddef.h>
+#include "jy901-frame.hpp"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+/** @file
+ *
+ * Batch decoder of recorded JY901_Frame arrays for host post processing.
+ * The AVX2 kernel is selected at compile time (-mavx2),
+ * otherwise the scalar path is used. All paths give the same result,
+ * which is the per-frame decode within float rounding (value = raw * LSB).
+ */
+
+/** JY901_Batch_Output
+ * Structure of arrays destination. Every pointer must have room for count values.
+ * Leave a pointer 0 to skip the component.
+ */
+typedef struct{
+    float *ax, *ay, *az;
+    float *gx, *gy, *gz;
+    float *mx, *my, *mz;
+    float *roll, *pitch, *yow;
+    float *temp;
+    float *q0, *q1, *q2, *q3;
+} JY901_Batch_Output;
+
+class JY901_Batch
+{
+public:
+    /** decode
+    * @bref decode count frames into structure of arrays.
+    * @param frames : contiguous array of raw frames.
+    * @param count  : number of frames.
+    * @param out    : destination arrays.
+    */
+    static void decode(const JY901_Frame *frames, size_t count, const JY901_Batch_Output &out){
+        using namespace JY901_Reg;
+        /* frames are processed in blocks that stay in L1 cache while every channel is extracted */
+        for(size_t i = 0; i < count; i += BLOCK){
+            size_t n = count - i < BLOCK ? count - i : BLOCK;
+            const JY901_Frame *f = &frames[i];
+            channel<ACC_X>(f, n, out.ax, i);
+            channel<ACC_Y>(f, n, out.ay, i);
+            channel<ACC_Z>(f, n, out.az, i);
+            channel<GYRO_X>(f, n, out.gx, i);
+            channel<GYRO_Y>(f, n, out.gy, i);
+            channel<GYRO_Z>(f, n, out.gz, i);
+            channel<MAG_X>(f, n, out.mx, i);
+            channel<MAG_Y>(f, n, out.my, i);
+            channel<MAG_Z>(f, n, out.mz, i);
+            channel<ROLL>(f, n, out.roll, i);
+            channel<PITCH>(f, n, out.pitch, i);
+            channel<YOW>(f, n, out.yow, i);
+            channel<TEMP>(f, n, out.temp, i);
+            channel<Q0>(f, n, out.q0, i);
+            channel<Q1>(f, n, out.q1, i);
+            channel<Q2>(f, n, out.q2, i);
+            channel<Q3>(f, n, out.q3, i);
+        }
+    }
+
+    /** decode_scalar
+    * @bref same as decode without SIMD. Reference for tests and benchmarks.
+    */
+    static void decode_scalar(const JY901_Frame *frames, size_t count, const JY901_Batch_Output &out){
+        using namespace JY901_Reg;
+        scalar<ACC_X>(frames, 0, count, out.ax);
+        scalar<ACC_Y>(frames, 0, count, out.ay);
+        scalar<ACC_Z>(frames, 0, count, out.az);
+        scalar<GYRO_X>(frames, 0, count, out.gx);
+        scalar<GYRO_Y>(frames, 0, count, out.gy);
+        scalar<GYRO_Z>(frames, 0, count, out.gz);
+        scalar<MAG_X>(frames, 0, count, out.mx);
+        scalar<MAG_Y>(frames, 0, count, out.my);
+        scalar<MAG_Z>(frames, 0, count, out.mz);
+        scalar<ROLL>(frames, 0, count, out.roll);
+        scalar<PITCH>(frames, 0, count, out.pitch);
+        scalar<YOW>(frames, 0, count, out.yow);
+        scalar<TEMP>(frames, 0, count, out.temp);
+        scalar<Q0>(frames, 0, count, out.q0);
+        scalar<Q1>(frames, 0, count, out.q1);
+        scalar<Q2>(frames, 0, count, out.q2);
+        scalar<Q3>(frames, 0, count, out.q3);
+    }
+
+private:
+    static const size_t BLOCK = 256;
+
+    /* float multiplier equal to Scale::to_float for 16bit registers */
+    template <class Reg>
+    static float lsb(void){
+        return Reg::scale::to_float((short)1);
+    }
+
+    template <class Reg>
+    static void scalar(const JY901_Frame *frames, size_t from, size_t count, float *dst){
+        if(!dst) return;
+        const float k = lsb<Reg>();
+        for(size_t i = from; i < count; i++) dst[i] = frames[i].raw<Reg>() * k;
+    }
+
+    template <class Reg>
+    static void channel(const JY901_Frame *frames, size_t count, float *dst, size_t dst_offset){
+        if(!dst) return;
+        dst += dst_offset;
+        size_t i = 0;
+#if defined(__AVX2__)
+        /* gather 8 x 32bit words ending at the value (stride = frame size),
+         * so the short is in the upper half and never read past the frame. */
+        const char *base = frames->data() + (Reg::addr - JY_SNAPSHOT_ADDR) * 2;
+        const __m256i idx  = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+                                                _mm256_set1_epi32((int)sizeof(JY901_Frame)));
+        const __m256  k    = _mm256_set1_ps(lsb<Reg>());
+        for(; i + 8 <= count; i += 8){
+            __m256i v = _mm256_i32gather_epi32((const int *)(base - 2 + i * sizeof(JY901_Frame)), idx, 1);
+            v = _mm256_srai_epi32(v, 16);
+            _mm256_storeu_ps(&dst[i], _mm256_mul_ps(_mm256_cvtepi32_ps(v), k));
+        }
+#endif
+        scalar<Reg>(frames, i, count, dst);
+    }
+};
@@ -0,0 +1,178 @@
+#pragma once
+#include "mbed.h"
+#include "jy901.hpp"
+
+/** @file
+ *
+ * Mapping between the JY901 clock (0x30 - 0x33) and the MCU us ticker.
+ */
+
+/** JY901_Clock_Sync Class
+ * Pairs get_time readings with us_ticker_read and fits
+ *   host_us = host(module_ms)
+ * as a line (offset and drift) with exponentially weighted least squares.
+ * Each pairing takes the middle of the read as host time and is dropped when
+ * the read took much longer than the fastest one seen (bus contention).
+ * A module clock step larger than step_us (EX GPS fix) restarts the fit.
+ * EX
+ *   JY901_Clock_Sync<> sync(&imu);
+ *   loop: sync.service(); t = sync.to_host_us(recorded_time);
+ */
+template <class Device = JY901>
+class JY901_Clock_Sync
+{
+public:
+    /** constructor
+    * @param imu       : JY901 (or JY901_T<Bus>) instance.
+    * @param period_us : interval of pairing by service.
+    * @param window    : number of pairings the fit remembers.
+    * @param step_us   : residual that is taken as a step of the module clock.
+    */
+    JY901_Clock_Sync(Device *imu, unsigned long period_us = 1000000, int window = 16,
+                     unsigned long step_us = 100000)
+        : imu(imu), period_us(period_us), window(window), step_us(step_us) {
+        reset();
+    }
+
+    /** reset
+    * @bref forget every pairing.
+    */
+    void reset(void){
+        n = 0;
+        rejected = 0;
+        steps = 0;
+        min_rtt = 0xffffffff;
+        slope = 1;
+        mx = my = cxx = cxy = 0;
+        residual_us = 0;
+        host_high = 0;
+        host_last = us_ticker_read();
+        last_sync = host_last;
+    }
+
+    /** service
+    * @bref call from the main loop. Pairs once per period_us.
+    * @return true when a pairing was taken.
+    */
+    bool service(void){
+        if(n && (uint32_t)(us_ticker_read() - last_sync) < period_us) return false;
+        return sync();
+    }
+
+    /** sync
+    * @bref read the module time now and update the fit.
+    * @return false when the pairing was rejected.
+    */
+    bool sync(void){
+        uint32_t t0 = us_ticker_read();
+        JY_Time time = imu->get_time();
+        uint32_t t1 = us_ticker_read();
+        last_sync = t1;
+        uint32_t rtt = t1 - t0;
+        if(rtt < min_rtt) min_rtt = rtt;
+        if(rtt > 2 * min_rtt + 100){
+            rejected++;
+            return false;
+        }
+        add(module_ms(time) * 1000.0, (double)extend(t0 + rtt / 2));
+        return true;
+    }
+
+    /** to_host_us
+    * @bref host time (us_ticker_read domain) when the module clock showed time.
+    */
+    uint32_t to_host_us(const JY_Time &time){
+        return (uint32_t)(long long)host_of(module_ms(time) * 1000.0);
+    }
+
+    /** to_module_ms
+    * @bref module time at host_us, in milli sec from 2000-01-01 00:00:00.
+    * @param host_us : us_ticker_read value within 35 minutes from now.
+    */
+    long long to_module_ms(uint32_t host_us){
+        uint32_t now = us_ticker_read();
+        double host = (double)extend(now) - (double)(int32_t)(now - host_us);
+        if(!n) return 0;
+        return (long long)((mx + (host - my) / slope) / 1000.0);
+    }
+
+    /** module_ms
+    * @bref module time in milli sec from 2000-01-01 00:00:00.
+    */
+    static long long module_ms(const JY_Time &time){
+        int y = time.year;
+        int m = time.month;
+        if(m <= 2){ y--; m += 12; }
+        /* days from 0000-03-01, then from 2000-01-01 */
+        long days = 365L * y + y / 4 - y / 100 + y / 400 + (153 * (m - 3) + 2) / 5 + time.day - 1 - 730425L;
+        return ((days * 24 + time.hour) * 60 + time.min) * 60000LL + time.sec * 1000LL + time.ms;
+    }
+
+    /** drift of the module clock against the host, in ppm (positive: module runs slow). */
+    float get_drift_ppm(void) const { return (float)((slope - 1) * 1e6); }
+    /** distance of the last pairing from the fit in micro sec. */
+    float get_residual_us(void) const { return (float)residual_us; }
+    /** pairings in the current fit */
+    int get_samples(void) const { return n; }
+    unsigned long get_rejected(void) const { return rejected; }
+    unsigned long get_steps(void) const { return steps; }
+    /** shortest get_time seen in micro sec */
+    uint32_t get_min_read_us(void) const { return min_rtt; }
+
+private:
+    double host_of(double module_us) const {
+        if(!n) return 0;
+        return my + slope * (module_us - mx);
+    }
+
+    void add(double x, double y){
+        if(n >= 2){
+            residual_us = y - host_of(x);
+            if(residual_us > step_us || residual_us < -(double)step_us){
+                steps++;
+                n = 0;
+            }
+        }
+        if(!n){
+            mx = x;
+            my = y;
+            cxx = cxy = 0;
+            slope = 1;
+            residual_us = 0;
+            n = 1;
+            return;
+        }
+        if(n < window) n++;
+        double a  = 1.0 / n;
+        double dx = x - mx;
+        double dy = y - my;
+        mx  += a * dx;
+        my  += a * dy;
+        cxx = (1 - a) * (cxx + a * dx * dx);
+        cxy = (1 - a) * (cxy + a * dx * dy);
+        if(cxx > 0) slope = cxy / cxx;
+    }
+
+    /* 64bit host time. Needs a call at least once per 71 minutes (service does). */
+    uint64_t extend(uint32_t host_us){
+        uint32_t now = us_ticker_read();
+        if(now < host_last) host_high += 1ull << 32;
+        host_last = now;
+        return (host_high | now) - (uint32_t)(now - host_us);
+    }
+
+    Device *imu;
+    unsigned long period_us;
+    int window;
+    unsigned long step_us;
+    int n;
+    unsigned long rejected;
+    unsigned long steps;
+    uint32_t min_rtt;
+    uint32_t last_sync;
+    uint32_t host_last;
+    uint64_t host_high;
+    double slope;
+    double mx, my, cxx, cxy;
+    double residual_us;
+};
@@ -0,0 +1,186 @@
+#pragma once
+#include "mbed.h"
+#include "jy901.hpp"
+#include "jy901-ring-buffer.hpp"
+
+/** @file
+ *
+ * Multi-rate field scheduler for one JY901.
+ */
+
+/** JY901_Field_Scheduler Class
+ * Every field has its own period. service() reads all fields that are due
+ * (and those due within slack_us) together, so the read plan merges them
+ * into the fewest burst reads.
+ * EX
+ *   JY901_Field_Scheduler<> sched(&imu);
+ *   sched.set_rate(JY_FIELD_ANGLE, 200);
+ *   sched.set_rate(JY_FIELD_ANGULAR_VELOCITY, 100);
+ *   sched.set_rate(JY_FIELD_PRESSURE_HEIGHT, 10);
+ *   sched.set_rate(JY_FIELD_TEMPERTURE, 1);
+ *   sched.set_rate(JY_FIELD_POSITION, 5);
+ *   loop: sched.service(); if(sched.read(&data) & JY_FIELD_ANGLE) ...
+ * @param Device : JY901_T<Bus> or JY901_GPS_T<Bus> type.
+ */
+template <class Device = JY901>
+class JY901_Field_Scheduler
+{
+public:
+    /** constructor
+    * @param imu     : device. Don't access it directly while scheduled.
+    * @param slack_us: fields due within slack_us are read together with the due ones.
+    */
+    JY901_Field_Scheduler(Device *imu, unsigned long slack_us = 0)
+        : imu(imu), slack_us(slack_us), enabled(0), busy(false), pending(0),
+          release(0), seq(0), read_seq(0), reads(0), errors(0), max_latency(0) {
+        memset(period, 0, sizeof(period));
+        memset(missed, 0, sizeof(missed));
+        memset(field_seq, 0, sizeof(field_seq));
+        memset(&latest, 0, sizeof(latest));
+#if DEVICE_I2C_ASYNCH
+        imu->attach_async_error(Callback<void(int)>(this, &JY901_Field_Scheduler::on_error));
+#endif
+    }
+
+    /** set_period
+    * @bref set read period of fields.
+    * @param field_mask : OR of JY901_Type::JY_Field.
+    * @param period_us  : period in micro sec, 0 to stop reading them.
+    * @remarks The fields are due immediately.
+    */
+    void set_period(unsigned int field_mask, unsigned long period_us){
+        uint32_t now = us_ticker_read();
+        for(int i = 0; i < JY_FIELD_COUNT; i++){
+            if(!(field_mask & (1u << i))) continue;
+            period[i]   = period_us;
+            deadline[i] = now;
+        }
+        if(period_us) enabled |= field_mask & JY_FIELD_ALL;
+        else          enabled &= ~field_mask;
+    }
+    /** set_rate
+    * @bref same as set_period in Hz.
+    */
+    void set_rate(unsigned int field_mask, float hz){
+        set_period(field_mask, hz > 0 ? (unsigned long)(1000000 / hz) : 0);
+    }
+
+    /** service
+    * @bref read due fields. Call from the main loop more often than the fastest rate.
+    * @return field mask of the started (or with blocking bus, done) read, 0 if nothing was due.
+    */
+    unsigned int service(void){
+        if(busy) return 0;
+        uint32_t now = us_ticker_read();
+        unsigned int due = 0;
+        for(int i = 0; i < JY_FIELD_COUNT; i++){
+            if((enabled & (1u << i)) && (int32_t)(now - deadline[i]) >= 0) due |= 1u << i;
+        }
+        if(!due) return 0;
+        release = now;
+        for(int i = 0; i < JY_FIELD_COUNT; i++){
+            if(!(enabled & (1u << i))) continue;
+            int32_t late = (int32_t)(now - deadline[i]);
+            if(late < -(int32_t)slack_us) continue;
+            due |= 1u << i;
+            if(late > 0 && (int32_t)(release - deadline[i]) > 0) release = deadline[i];
+            deadline[i] += period[i];
+            while((int32_t)(now - deadline[i]) >= 0){
+                deadline[i] += period[i];
+                missed[i]++;
+            }
+        }
+        reads++;
+        pending = due;
+#if DEVICE_I2C_ASYNCH
+        busy = true;
+        if(!imu->get_fields_async(due, Callback<void(const JY_Snapshot&)>(this, &JY901_Field_Scheduler::on_done))) return due;
+        busy = false;
+#endif
+        JY_Snapshot data;
+        imu->get_fields(due, &data);
+        store(data, due);
+        return due;
+    }
+
+    /** read
+    * @bref copy latest data of every field.
+    * @param data : destination. Every field keeps its latest value.
+    * @return field mask updated since the previous read.
+    */
+    unsigned int read(JY_Snapshot *data){
+        unsigned int s;
+        unsigned int stored[JY_FIELD_COUNT];
+        do{
+            s = seq;
+            JY_RING_BARRIER();
+            *data = latest;
+            memcpy(stored, field_seq, sizeof(stored));
+            JY_RING_BARRIER();
+        }while((s & 1) || s != seq);
+        unsigned int mask = 0;
+        for(int i = 0; i < JY_FIELD_COUNT; i++){
+            if((int)(stored[i] - read_seq) > 0) mask |= 1u << i;
+        }
+        read_seq = s;
+        return mask;
+    }
+
+    unsigned int get_enabled(void) const { return enabled; }
+    /** number of periods of field (JY_Field bit number) skipped because the bus was too busy. */
+    unsigned long get_missed(int field_index) const { return missed[field_index]; }
+    /** number of started reads. */
+    unsigned long get_reads(void) const { return reads; }
+    unsigned long get_errors(void) const { return errors; }
+    /** worst time from the earliest due deadline of a read to its data in micro sec. */
+    uint32_t get_max_latency_us(void) const { return max_latency; }
+
+private:
+    void store(const JY_Snapshot &d, unsigned int mask){
+        uint32_t now = us_ticker_read();
+        seq++;
+        JY_RING_BARRIER();
+        merge(d, mask);
+        for(int i = 0; i < JY_FIELD_COUNT; i++){
+            if(mask & (1u << i)) field_seq[i] = seq + 1;
+        }
+        JY_RING_BARRIER();
+        seq++;
+        if(now - release > max_latency) max_latency = now - release;
+    }
+    void merge(const JY_Snapshot &d, unsigned int mask){
+        Device::copy_fields(d, &latest, mask);
+        /* .temp of 3D fields follows the temperture field, which has its own rate */
+        latest.acceleration.temp     = latest.temperture;
+        latest.angular_velocity.temp = latest.temperture;
+        latest.magnetic.temp         = latest.temperture;
+    }
+#if DEVICE_I2C_ASYNCH
+    void on_done(const JY_Snapshot &d){
+        store(d, pending);
+        busy = false;
+    }
+    void on_error(int event){
+        (void)event;
+        errors++;
+        busy = false;
+    }
+#endif
+
+    Device *imu;
+    unsigned long slack_us;
+    unsigned int enabled;
+    unsigned long period[JY_FIELD_COUNT];
+    uint32_t deadline[JY_FIELD_COUNT];
+    unsigned long missed[JY_FIELD_COUNT];
+    volatile bool busy;
+    unsigned int pending;
+    uint32_t release;
+    volatile unsigned int seq;
+    unsigned int read_seq;
+    unsigned int field_seq[JY_FIELD_COUNT];
+    JY_Snapshot latest;
+    unsigned long reads;
+    unsigned long errors;
+    uint32_t max_latency;
+};
@@ -0,0 +1,95 @@
+#pragma once
+#include "jy901-type.hpp"
+#include "jy901-registers.hpp"
+
+/** @file
+ *
+ * Raw frame of the JY901 output register block.
+ */
+
+/** JY901_Frame Class
+ * Little endian register bytes 0x30 - 0x54 laid out exactly as on the bus.
+ * Burst reads land directly in it. Accessors decode only the touched value,
+ * so the frame can also be stored or forwarded as-is.
+ */
+struct JY901_Frame
+{
+    char time[8];             /* 0x30 - 0x33 */
+    char acceleration[6];     /* 0x34 - 0x36 */
+    char angular_velocity[6]; /* 0x37 - 0x39 */
+    char magnetic[6];         /* 0x3a - 0x3c */
+    char angle[6];            /* 0x3d - 0x3f */
+    char temperture[2];       /* 0x40 */
+    char pin_status[8];       /* 0x41 - 0x44 */
+    char pressure[4];         /* 0x45 - 0x46 */
+    char height[4];           /* 0x47 - 0x48 */
+    char longitude[4];        /* 0x49 - 0x4a */
+    char latitude[4];         /* 0x4b - 0x4c */
+    char gps[8];              /* 0x4d - 0x50 */
+    char quaternion[8];       /* 0x51 - 0x54 */
+
+    char *data(void) { return time; }
+    const char *data(void) const { return time; }
+    /** pointer to register reg in the frame. */
+    char *at(int reg) { return &time[(reg - JY_SNAPSHOT_ADDR) * 2]; }
+    const char *at(int reg) const { return &time[(reg - JY_SNAPSHOT_ADDR) * 2]; }
+
+    /** raw
+    * @bref register value described in JY901_Reg (EX frame.raw<JY901_Reg::ACC_X>()).
+    */
+    template <class Reg>
+    typename Reg::raw_type raw(void) const {
+        return Reg::raw_at(time, JY_SNAPSHOT_ADDR);
+    }
+
+    /** value
+    * @bref scaled value described in JY901_Reg (EX frame.value<JY901_Reg::ROLL>()).
+    */
+    template <class Reg>
+    float value(void) const {
+        return Reg::value_at(time, JY_SNAPSHOT_ADDR);
+    }
+
+    template <class X, class Y, class Z>
+    JY901_Type::JY_Dim_3D dim_3d(void) const {
+        JY901_Type::JY_Dim_3D ret;
+        ret.x    = value<X>();
+        ret.y    = value<Y>();
+        ret.z    = value<Z>();
+        ret.temp = value<JY901_Reg::TEMP>();
+        return ret;
+    }
+
+    JY901_Type::JY_Dim_3D get_acceleration(void) const {
+        return dim_3d<JY901_Reg::ACC_X, JY901_Reg::ACC_Y, JY901_Reg::ACC_Z>();
+    }
+    JY901_Type::JY_Dim_3D get_angular_velocity(void) const {
+        return dim_3d<JY901_Reg::GYRO_X, JY901_Reg::GYRO_Y, JY901_Reg::GYRO_Z>();
+    }
+    JY901_Type::JY_Dim_3D get_magnetic(void) const {
+        return dim_3d<JY901_Reg::MAG_X, JY901_Reg::MAG_Y, JY901_Reg::MAG_Z>();
+    }
+    JY901_Type::JY_Pitch_Angle get_pitch_angle(void) const {
+        JY901_Type::JY_Pitch_Angle ret;
+        ret.roll  = value<JY901_Reg::ROLL>();
+        ret.pitch = value<JY901_Reg::PITCH>();
+        ret.yow   = value<JY901_Reg::YOW>();
+        return ret;
+    }
+    float get_temperture(void) const {
+        return value<JY901_Reg::TEMP>();
+    }
+    JY901_Type::JY_Quaternion get_quaternion(void) const {
+        JY901_Type::JY_Quaternion ret;
+        ret.quat0 = value<JY901_Reg::Q0>();
+        ret.quat1 = value<JY901_Reg::Q1>();
+        ret.quat2 = value<JY901_Reg::Q2>();
+        ret.quat3 = value<JY901_Reg::Q3>();
+        return ret;
+    }
+    unsigned short get_ms(void) const {
+        return raw<JY901_Reg::MS>();
+    }
+};
+
+static_assert(sizeof(JY901_Frame) == JY_SNAPSHOT_BYTES, "JY901_Frame must match the register block");
@@ -0,0 +1,146 @@
+#pragma once
+#include "mbed.h"
+#include "jy901.hpp"
+
+/** @file
+ *
+ * Freshness aware reading of JY901.
+ */
+
+/** JY901_Fresh_Reader Class
+ * Detects a new output of the module by comparing acceleration and angular
+ * velocity (JY_PROBE_ADDR, one 12 byte read) with the last probe. The time
+ * registers can't be used, they run with the module clock between outputs.
+ * Only a new output is read with the full burst, otherwise the cached sample
+ * is returned.
+ *
+ * wait_and_read also learns when the module updates: it probes at the
+ * predicted update time plus a guard. While the first probe already sees
+ * new data the prediction moves earlier by a doubling step, when it does not
+ * the update is located between two retry probes and the guard widens,
+ * so the data is picked up shortly after the module produced it.
+ * @remarks JY901 has no data ready output (pin modes are analog, digital and PWM). <br>
+ *          An output with bit-identical acceleration and angular velocity is taken as no
+ *          new output, sensor noise makes that rare.
+ */
+template <class Device = JY901>
+class JY901_Fresh_Reader
+{
+public:
+    /** constructor
+    * @param imu        : JY901 (or JY901_T<Bus>) instance.
+    * @param field_mask : OR of JY901_Type::JY_Field to be read on new output.
+    * @param retry_us   : interval of probes while waiting for the update.
+    */
+    JY901_Fresh_Reader(Device *imu, unsigned int field_mask = JY_FIELD_ALL, unsigned long retry_us = 250)
+        : imu(imu), mask(field_mask), retry_us(retry_us), valid(false),
+          update_us(0), guard_us(retry_us), step_us(retry_us / 4), probes(0), bursts(0), misses(0) {
+        memset(&cache, 0, sizeof(cache));
+        memset(last, 0, sizeof(last));
+    }
+
+    /** read
+    * @bref read fields if the module has a new output.
+    * @param data : latest sample, from cache when nothing changed.
+    * @return true when data is a new output.
+    */
+    bool read(JY_Snapshot *data){
+        bool fresh = probe();
+        if(fresh){
+            imu->get_fields(mask, &cache);
+            bursts++;
+        }
+        *data = cache;
+        return fresh;
+    }
+
+    /** wait_and_read
+    * @bref block until the next output of the module and read it.
+    * @param data       : new sample, or cached one on timeout.
+    * @param timeout_us : give up after this, 0 for two output periods.
+    * @return true when data is a new output.
+    */
+    bool wait_and_read(JY_Snapshot *data, unsigned long timeout_us = 0){
+        unsigned long period = Device::rate_to_period_us(imu->get_return_rate());
+        if(!timeout_us) timeout_us = period ? 2 * period : 1000000;
+        uint32_t start = us_ticker_read();
+        if(valid && period){
+            int32_t wait = (int32_t)(get_next_poll_us() - start);
+            if(wait > 0 && (unsigned long)wait <= period + guard_us) wait_us(wait);
+        }
+        bool first = true;
+        uint32_t probe_at = us_ticker_read();
+        while(!read(data)){
+            if(first && valid){
+                /* the first probe was too early */
+                guard_us += retry_us;
+                if(period && guard_us > period / 2) guard_us = period / 2;
+                misses++;
+            }
+            first = false;
+            if((uint32_t)(us_ticker_read() - start) >= timeout_us) return false;
+            wait_us(retry_us);
+            probe_at = us_ticker_read();
+        }
+        if(period){
+            if(first){
+                /* new data at the first probe: the update can be much earlier than predicted.
+                 * Move the prediction earlier by a doubling step until a probe misses. */
+                if(guard_us > retry_us) guard_us -= guard_us / 4;
+                update_us = probe_at - guard_us - step_us;
+                step_us   = step_us * 2 < period / 4 ? step_us * 2 : period / 4;
+            }else{
+                /* update happened between the last two probes */
+                update_us = probe_at - retry_us / 2;
+                step_us   = retry_us / 4;
+            }
+        }
+        valid = true;
+        return true;
+    }
+
+    /** get_next_poll_us
+    * @bref us_ticker_read time of the next probe by wait_and_read.
+    */
+    uint32_t get_next_poll_us(void){
+        unsigned long period = Device::rate_to_period_us(imu->get_return_rate());
+        if(!period) return us_ticker_read();
+        uint32_t next = update_us + period + guard_us;
+        uint32_t now  = us_ticker_read();
+        while((int32_t)(now - next) >= 0) next += period;
+        return next;
+    }
+
+    /** estimated us_ticker_read time of the last module output. */
+    uint32_t get_update_us(void) const { return update_us; }
+    uint32_t get_guard_us(void) const { return guard_us; }
+    /** number of probe reads */
+    unsigned long get_probes(void) const { return probes; }
+    /** number of full reads */
+    unsigned long get_bursts(void) const { return bursts; }
+    /** number of probes by wait_and_read before the output was ready */
+    unsigned long get_misses(void) const { return misses; }
+
+private:
+    bool probe(void){
+        char buff[JY_PROBE_REGS * 2];
+        imu->read(JY_PROBE_ADDR, buff, sizeof(buff));
+        probes++;
+        if(bursts && !memcmp(buff, last, sizeof(buff))) return false;
+        memcpy(last, buff, sizeof(buff));
+        return true;
+    }
+
+    Device *imu;
+    unsigned int mask;
+    unsigned long retry_us;
+    char last[JY_PROBE_REGS * 2];
+    bool valid;
+    uint32_t update_us;
+    uint32_t guard_us;
+    uint32_t step_us;
+    unsigned long probes;
+    unsigned long bursts;
+    unsigned long misses;
+    JY_Snapshot cache;
+};
@@ -1,17 +1,18 @@
 #pragma once
 
-class JY901_GPS 
-    : public JY901
+template <class Bus = I2C>
+class JY901_GPS_T 
+    : public JY901_T<Bus>
 {
 public:
-    JY901_GPS (I2C *bus): JY901(bus) {
+    JY901_GPS_T (Bus *bus): JY901_T<Bus>(bus) {
         set_gps_mode();
     }
-    JY901_GPS (I2C *bus,  char address): JY901(bus, address) {
+    JY901_GPS_T (Bus *bus,  char address): JY901_T<Bus>(bus, address) {
         set_gps_mode();
     }
     void set_GPS_baud(JY_Serial_Baud gps_baud){
-        this->write(0x1C, (char)gps_baud);
+        this->write_config(0x1C, (unsigned char)gps_baud);
     }
 
 
@@ -23,9 +24,9 @@ public:
     * @remarks If you use with GPS, you can't use pin1.
     */
      void set_pin_mode (int pin_ID, JY_Pin_Mode pin_mode){
-        if(pin_ID > 3) return;
+        if(pin_ID < 0 || pin_ID > 3) return;
         if(pin_ID == 1) return;
-        this->write( (char)(0x0e + pin_ID), (char)pin_mode);
+        this->write_config((char)(0x0e + pin_ID), (unsigned short)pin_mode);
     }
 
   
@@ -37,9 +38,9 @@ public:
     * @remarks If you use with GPS, you can't use pin1.
     */
     void set_pin_write(int pin_ID, int state){
-        if(pin_ID > 3) return;
+        if(pin_ID < 0 || pin_ID > 3) return;
         if(pin_ID == 1) return;
-        this->write( (char)(0x0e + pin_ID), (char)(0x10|(state&1)));
+        this->write_config((char)(0x0e + pin_ID), (unsigned short)(0x10|(state&1)));
     }
 
    /** set_pwm_width
@@ -49,13 +50,9 @@ public:
     * @remarks If you use with GPS, you can't use pin1.
     */
     void set_pwm_width (int pin_ID, unsigned short high_width_us){
-        char dum[2];
-        if(pin_ID > 3) return;
+        if(pin_ID < 0 || pin_ID > 3) return;
         if(pin_ID == 1) return;
-
-        dum[0] = high_width_us & 0x00FF;
-        dum[1] = high_width_us >> 8;
-        this->write( (char)(0x12 + pin_ID), dum, 2);
+        this->write_config((char)(0x12 + pin_ID), high_width_us);
     }
 
    /** set_pwm_power
@@ -66,11 +63,11 @@ public:
     * @remarks If you use with GPS, you can't use pin1.
     */
     void set_pwm_power (int pin_ID, float duty_rate){
-        if(pin_ID > 3) return;
+        if(pin_ID < 0 || pin_ID > 3) return;
         if(pin_ID == 1) return;
         if(duty_rate < 0) duty_rate = 0;
         if(duty_rate > 1) duty_rate = 1;
-        set_pwm_width(pin_ID, (unsigned short)(duty_rate * periods[pin_ID]));
+        set_pwm_width(pin_ID, (unsigned short)(duty_rate * this->periods[pin_ID]));
     }
 
    /** set_pwm_period
@@ -80,28 +77,71 @@ public:
     * @remarks If you use with GPS, you can't use pin1.
     */
     void set_pwm_period (int pin_ID, unsigned short period_us){
-        char dum[2];
-        if(pin_ID > 3) return;
+        if(pin_ID < 0 || pin_ID > 3) return;
         if(pin_ID == 1) return;
-        dum[0] = period_us & 0x00FF;
-        dum[1] = period_us >> 8;
-        this->write( (char)(0x16 + pin_ID), dum, 2);
-        periods[pin_ID] = period_us;
+        this->write_config((char)(0x16 + pin_ID), period_us);
+        this->periods[pin_ID] = period_us;
+    }
+
+   /** set_pwm_widths
+    * @bref set pwm width length of pin 0, 2 and 3.
+    * @param high_width_us : length pin out high voltage in micro sec, index is pin number.
+    * @remarks If you use with GPS, you can't use pin1. <br>Pin 0 and pin 2-3 are written back-to-back.
+    */
+    void set_pwm_widths (const unsigned short high_width_us[4]){
+        set_registers_except_pin1(0x12, high_width_us);
+    }
+
+   /** set_pwm_powers
+    * @bref set pwm duty rate of pin 0, 2 and 3.
+    * @param duty_rate : setting duty rate in range 0 to 1, index is pin number.
+    * @remarks If you use with GPS, you can't use pin1.
+    */
+    void set_pwm_powers (const float duty_rate[4]){
+        unsigned short widths[4];
+        for(int i = 0; i < 4; i++){
+            float d = duty_rate[i];
+            if(d < 0) d = 0;
+            if(d > 1) d = 1;
+            widths[i] = (unsigned short)(d * this->periods[i]);
+        }
+        set_pwm_widths(widths);
+    }
+
+   /** set_pwm_periods
+    * @bref set pwm period length of pin 0, 2 and 3.
+    * @param period_us : pwm period length, index is pin number.
+    * @remarks If you use with GPS, you can't use pin1.
+    */
+    void set_pwm_periods (const unsigned short period_us[4]){
+        set_registers_except_pin1(0x16, period_us);
+        this->periods[0] = period_us[0];
+        this->periods[2] = period_us[2];
+        this->periods[3] = period_us[3];
     }
 
 
 
     JY_Geographical_Position get_geographical_position(void){
         JY_Geographical_Position position_state;
-        char buff[9];
-        this->read(0x57, buff, 9);
-
-        position_state.longitude = ( buff[3]<<24)| ( buff[2]<<16)| ( buff[1]<<8)| buff[0]; 
-        position_state.latitude   = ( buff[7]<<24)| ( buff[6]<<16)| ( buff[5]<<8)| buff[4]; 
+        char buff[8];
+        this->read(JY901_Reg::LON::addr, buff, 8);
+        position_state.longitude = JY901_Reg::LON::value_at(buff, JY901_Reg::LON::addr);
+        position_state.latitude  = JY901_Reg::LAT::value_at(buff, JY901_Reg::LON::addr);
         return position_state;  
     }
 private:
+    /* pin 0 and pin 2-3 are two bursts, queued and flushed back-to-back */
+    void set_registers_except_pin1(char base, const unsigned short values[4]){
+        typename MyI2C_T<Bus>::Transaction tx(this);
+        this->write_config_block(base, &values[0], 1, &tx);
+        this->write_config_block((char)(base + 2), &values[2], 2, &tx);
+        tx.flush();
+    }
+
     void set_gps_mode(void){
 
     }
-};
\ No newline at end of file
+};
+
+typedef JY901_GPS_T<I2C> JY901_GPS;
@@ -0,0 +1,367 @@
+#pragma once
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include "jy901-frame.hpp"
+#include "jy901-read-plan.hpp"
+
+/** @file
+ *
+ * Compact binary log of raw JY901 registers.
+ *
+ * The log is a sequence of self-contained blocks, appended with a single write each.
+ *   header  : "JYL1", mask(u16), count(u16), payload bytes(u16), first timestamp(u32), crc32(u32)
+ *   payload : per sample, varint of timestamp delta, then per register
+ *             varint of zigzag(register - same register of previous sample).
+ * The first sample of a block is relative to timestamp of header and to 0,
+ * so a block decodes without any other block. A torn last block or corrupted
+ * bytes fail crc32 and the reader resyncs on the next magic.
+ * All multi byte values are little endian.
+ */
+
+#ifndef JY901_LOG_BLOCK
+#define JY901_LOG_BLOCK 512
+#endif
+
+#define JY901_LOG_HEADER 18
+
+/** JY901_Log Class
+ * Encoding helpers shared by the writer and the reader.
+ */
+class JY901_Log
+{
+public:
+    /** register_list
+    * @bref list the output registers of field_mask in log order.
+    * @param field_mask : OR of JY901_Type::JY_Field.
+    * @param regs       : destination, room for JY_SNAPSHOT_REGS registers.
+    * @return number of registers.
+    */
+    static int register_list(unsigned int field_mask, char *regs){
+        int n = 0;
+        for(int i = 0; i < JY901_Type::JY_FIELD_COUNT; i++){
+            if(!(field_mask & (1u << i))) continue;
+            char addr = JY901_Read_Plan::field_addr(i);
+            for(int j = 0; j < JY901_Read_Plan::field_regs(i); j++) regs[n++] = addr + j;
+        }
+        return n;
+    }
+
+    static uint32_t crc32(const char *p, size_t bytes, uint32_t crc = 0){
+        crc = ~crc;
+        for(size_t i = 0; i < bytes; i++){
+            crc ^= (unsigned char)p[i];
+            for(int b = 0; b < 8; b++) crc = (crc >> 1) ^ (0xedb88320u & (0u - (crc & 1)));
+        }
+        return ~crc;
+    }
+
+    static int put_varint(char *p, uint32_t v){
+        int n = 0;
+        while(v >= 0x80){
+            p[n++] = (char)(v | 0x80);
+            v >>= 7;
+        }
+        p[n++] = (char)v;
+        return n;
+    }
+
+    /* return bytes used or 0 when the varint runs over end */
+    static int get_varint(const char *p, const char *end, uint32_t *v){
+        uint32_t ret = 0;
+        for(int n = 0; n < 5 && p + n < end; n++){
+            ret |= (uint32_t)(p[n] & 0x7f) << (7 * n);
+            if(!(p[n] & 0x80)){
+                *v = ret;
+                return n + 1;
+            }
+        }
+        return 0;
+    }
+
+    static uint32_t zigzag(short v){ return (uint16_t)((v << 1) ^ (v >> 15)); }
+    static short unzigzag(uint32_t v){ return (short)((v >> 1) ^ (0u - (v & 1))); }
+
+    static void put_u16(char *p, uint16_t v){ p[0] = v; p[1] = v >> 8; }
+    static void put_u32(char *p, uint32_t v){ put_u16(p, v); put_u16(p + 2, v >> 16); }
+    static uint16_t get_u16(const char *p){ return (uint16_t)jy_le16(p); }
+    static uint32_t get_u32(const char *p){ return (uint32_t)jy_le32(p); }
+
+    static bool is_magic(const char *p){
+        return p[0] == 'J' && p[1] == 'Y' && p[2] == 'L' && p[3] == '1';
+    }
+};
+
+/** JY901_Log_Writer Class
+ * Streaming writer. Samples are encoded into a RAM block that is appended
+ * to the file with one fwrite and fflush when full, so at most one block
+ * is lost at power failure.
+ * A slowly changing sample of ACC, GYRO, ANGLE and QUATERNION takes about 16 bytes instead of 74.
+ */
+class JY901_Log_Writer
+{
+public:
+    /** constructor
+    * @param fp         : file opened for append ("ab").
+    * @param field_mask : OR of JY901_Type::JY_Field to be logged.
+    */
+    JY901_Log_Writer(FILE *fp, unsigned int field_mask = JY901_Type::JY_FIELD_ALL)
+        : fp(fp), count(0), payload(0), first_ts(0), prev_ts(0),
+          written_blocks(0), write_errors(0) {
+        set_field_mask(field_mask);
+    }
+
+    ~JY901_Log_Writer(){
+        flush();
+    }
+
+    /** set_field_mask
+    * @bref change logged fields. The pending block is flushed first.
+    */
+    void set_field_mask(unsigned int field_mask){
+        flush();
+        mask = field_mask & JY901_Type::JY_FIELD_ALL;
+        nregs = JY901_Log::register_list(mask, regs);
+    }
+
+    /** write
+    * @bref append one sample.
+    * @param timestamp_us : time of the sample.
+    * @param frame        : raw registers (EX from JY901::get_frame_fields).
+    * @return false when a full block could not be written to the file.
+    */
+    bool write(unsigned long timestamp_us, const JY901_Frame &frame){
+        bool ok = true;
+        if(payload + 5 + nregs * 3 > JY901_LOG_BLOCK - JY901_LOG_HEADER){
+            ok = flush();
+        }
+        char *p = &block[JY901_LOG_HEADER + payload];
+        char *begin = p;
+        if(!count){
+            first_ts = prev_ts = timestamp_us;
+            memset(prev, 0, sizeof(prev));
+        }
+        p += JY901_Log::put_varint(p, (uint32_t)(timestamp_us - prev_ts));
+        prev_ts = timestamp_us;
+        for(int i = 0; i < nregs; i++){
+            short v = jy_le16(&frame.data()[(regs[i] - JY_SNAPSHOT_ADDR) * 2]);
+            p += JY901_Log::put_varint(p, JY901_Log::zigzag((short)(v - prev[i])));
+            prev[i] = v;
+        }
+        payload += p - begin;
+        count++;
+        return ok;
+    }
+
+    /** flush
+    * @bref append the pending block and flush the file.
+    * @return false on write error. The block is dropped anyway.
+    */
+    bool flush(void){
+        if(!count) return true;
+        block[0] = 'J'; block[1] = 'Y'; block[2] = 'L'; block[3] = '1';
+        JY901_Log::put_u16(&block[4], mask);
+        JY901_Log::put_u16(&block[6], count);
+        JY901_Log::put_u16(&block[8], payload);
+        JY901_Log::put_u32(&block[10], first_ts);
+        JY901_Log::put_u32(&block[14], JY901_Log::crc32(&block[JY901_LOG_HEADER], payload,
+                                                        JY901_Log::crc32(&block[4], 10)));
+        size_t bytes = JY901_LOG_HEADER + payload;
+        bool ok = fwrite(block, 1, bytes, fp) == bytes && fflush(fp) == 0;
+        if(ok) written_blocks++;
+        else   write_errors++;
+        count = payload = 0;
+        return ok;
+    }
+
+    unsigned long get_written_blocks(void){ return written_blocks; }
+    unsigned long get_write_errors(void){ return write_errors; }
+
+private:
+    FILE *fp;
+    unsigned int mask;
+    char regs[JY_SNAPSHOT_REGS];
+    int nregs;
+    short prev[JY_SNAPSHOT_REGS];
+    char block[JY901_LOG_BLOCK];
+    int count;
+    int payload;
+    unsigned long first_ts;
+    unsigned long prev_ts;
+    unsigned long written_blocks;
+    unsigned long write_errors;
+};
+
+/** JY901_Log_Reader Class
+ * Sequential reader over a FILE, or over memory (EX a mmap of the log on host).
+ * Corrupted and torn blocks are skipped.
+ */
+class JY901_Log_Reader
+{
+public:
+    /** constructor
+    * @param fp : file opened for reading ("rb").
+    */
+    JY901_Log_Reader(FILE *fp)
+        : fp(fp), mem(0), size(0) { reset(); }
+
+    /** constructor
+    * @param data : log bytes, kept by caller while reading.
+    * @param size : bytes of data.
+    */
+    JY901_Log_Reader(const char *data, size_t size)
+        : fp(0), mem(data), size(size) { reset(); }
+
+    /** read
+    * @bref decode the next sample.
+    * @param timestamp_us : timestamp of the sample.
+    * @param frame        : registers in get_field_mask are written, others are left untouched.
+    * @return false at end of log.
+    */
+    bool read(unsigned long *timestamp_us, JY901_Frame *frame){
+        for(;;){
+            while(left == 0 || cursor == end){
+                if(!next_block()) return false;
+            }
+            if(decode_sample()) break;
+            /* the rest of the block can't be decoded, resync on the next one */
+            left = 0;
+            bad_blocks++;
+        }
+        for(int i = 0; i < nregs; i++){
+            char *p = frame->at(regs[i]);
+            p[0] = prev[i];
+            p[1] = prev[i] >> 8;
+        }
+        left--;
+        *timestamp_us = ts;
+        return true;
+    }
+
+    /** reset
+    * @bref rewind to the beginning of the log.
+    */
+    void reset(void){
+        pos = 0;
+        left = 0;
+        cursor = end = 0;
+        mask = 0;
+        nregs = 0;
+        bad_blocks = 0;
+        if(fp) fseek(fp, 0, SEEK_SET);
+    }
+
+    /** field mask of the current block */
+    unsigned int get_field_mask(void){ return mask; }
+    /** number of blocks skipped by crc error, bad header or truncated payload. */
+    unsigned long get_bad_blocks(void){ return bad_blocks; }
+
+private:
+    /* decode one sample at cursor into ts and prev. Nothing changes when it runs over end. */
+    bool decode_sample(void){
+        const char *p = cursor;
+        short next[JY_SNAPSHOT_REGS];
+        uint32_t v;
+        int n = JY901_Log::get_varint(p, end, &v);
+        if(!n) return false;
+        p += n;
+        uint32_t t = ts + v;
+        for(int i = 0; i < nregs; i++){
+            n = JY901_Log::get_varint(p, end, &v);
+            if(!n) return false;
+            p += n;
+            next[i] = (short)(prev[i] + JY901_Log::unzigzag(v));
+        }
+        memcpy(prev, next, nregs * sizeof(short));
+        ts     = t;
+        cursor = p;
+        return true;
+    }
+
+    /* copy n bytes at offset of the log into dst, false at end */
+    bool fetch(size_t offset, char *dst, size_t n){
+        if(mem){
+            if(offset + n > size) return false;
+            memcpy(dst, mem + offset, n);
+            return true;
+        }
+        if(fseek(fp, offset, SEEK_SET)) return false;
+        return fread(dst, 1, n, fp) == n;
+    }
+
+    /* log bytes from offset: all the rest of memory, or up to a block read from the file into buff */
+    const char *window(size_t offset, size_t *n){
+        if(mem){
+            *n = offset < size ? size - offset : 0;
+            return mem + offset;
+        }
+        *n = 0;
+        if(fseek(fp, offset, SEEK_SET)) return buff;
+        *n = fread(buff, 1, sizeof(buff), fp);
+        return buff;
+    }
+
+    /* move pos to the next magic, false when there is none */
+    bool find_magic(void){
+        for(;;){
+            size_t n;
+            const char *p = window(pos, &n);
+            if(n < 4) return false;
+            for(size_t i = 0; i + 4 <= n; i++){
+                if(JY901_Log::is_magic(p + i)){
+                    pos += i;
+                    return true;
+                }
+            }
+            /* a magic may straddle the end of the window */
+            pos += n - 3;
+        }
+    }
+
+    bool next_block(void){
+        char header[JY901_LOG_HEADER];
+        while(find_magic() && fetch(pos, header, JY901_LOG_HEADER)){
+            int bytes = JY901_Log::get_u16(&header[8]);
+            const char *payload = buff;
+            bool ok = bytes <= JY901_LOG_BLOCK - JY901_LOG_HEADER;
+            if(ok && mem){
+                ok = pos + JY901_LOG_HEADER + bytes <= size;
+                payload = mem + pos + JY901_LOG_HEADER;
+            }else if(ok){
+                ok = fetch(pos + JY901_LOG_HEADER, buff, bytes);
+            }
+            ok = ok && JY901_Log::crc32(payload, bytes, JY901_Log::crc32(&header[4], 10))
+                       == JY901_Log::get_u32(&header[14]);
+            if(!ok){
+                bad_blocks++;
+                pos++;
+                continue;
+            }
+            mask   = JY901_Log::get_u16(&header[4]);
+            nregs  = JY901_Log::register_list(mask, regs);
+            left   = JY901_Log::get_u16(&header[6]);
+            ts     = JY901_Log::get_u32(&header[10]);
+            cursor = payload;
+            end    = payload + bytes;
+            pos   += JY901_LOG_HEADER + bytes;
+            memset(prev, 0, sizeof(prev));
+            return true;
+        }
+        return false;
+    }
+
+    FILE *fp;
+    const char *mem;
+    size_t size;
+    size_t pos;
+    char buff[JY901_LOG_BLOCK];
+    const char *cursor;
+    const char *end;
+    int left;
+    unsigned int mask;
+    char regs[JY_SNAPSHOT_REGS];
+    int nregs;
+    short prev[JY_SNAPSHOT_REGS];
+    uint32_t ts;
+    unsigned long bad_blocks;
+};
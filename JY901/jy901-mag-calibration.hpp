@@ -0,0 +1,225 @@
+#pragma once
+#include <math.h>
+#include <string.h>
+#include "jy901-type.hpp"
+
+/** @file
+ *
+ * Streaming hard / soft iron calibration of the JY901 magnetometer.
+ */
+
+/** JY_Mag_Correction
+ * corrected = matrix * (raw - offset), in raw units of get_magnetic.
+ * matrix is row major and symmetric, it keeps the geometric mean radius of the field.
+ */
+struct JY_Mag_Correction
+{
+    float offset[3];
+    float matrix[9];
+
+    /** identity correction */
+    void reset(void){
+        memset(offset, 0, sizeof(offset));
+        memset(matrix, 0, sizeof(matrix));
+        matrix[0] = matrix[4] = matrix[8] = 1;
+    }
+
+    void apply(JY901_Type::JY_Dim_3D *m) const {
+        float x = m->x - offset[0];
+        float y = m->y - offset[1];
+        float z = m->z - offset[2];
+        m->x = matrix[0] * x + matrix[1] * y + matrix[2] * z;
+        m->y = matrix[3] * x + matrix[4] * y + matrix[5] * z;
+        m->z = matrix[6] * x + matrix[7] * y + matrix[8] * z;
+    }
+};
+
+/** JY901_Mag_Calibrator Class
+ * Least squares fit of the ellipsoid
+ *   a x^2 + b y^2 + c z^2 + 2d xy + 2e xz + 2f yz + 2g x + 2h y + 2i z = 1
+ * kept as running normal equations (54 sums), so add is constant time and
+ * no sample is stored. solve turns the fit into a JY_Mag_Correction.
+ * With forget < 1 old samples fade out and the calibration follows changes in the field.
+ * EX
+ *   JY901_Mag_Calibrator cal(0.999f);
+ *   JY_Mag_Correction corr;
+ *   imu.set_magnetic_correction(&corr);
+ *   loop: cal.add(imu.get_magnetic_raw()); if(++n % 100 == 0) cal.solve(&corr);
+ */
+class JY901_Mag_Calibrator
+{
+public:
+    static const int PARAMS = 9;
+
+    /** constructor
+    * @param forget        : weight of the old sums per sample, 1 to keep every sample.
+    * @param min_samples   : solve fails until this many samples were added.
+    * @param min_magnitude : samples shorter than this (raw units) are skipped until the
+    *                        normalization is set, so a zero read doesn't set it.
+    */
+    JY901_Mag_Calibrator(float forget = 1.0f, int min_samples = 50, float min_magnitude = 16)
+        : forget(forget), min_samples(min_samples), min_magnitude(min_magnitude) {
+        reset();
+    }
+
+    void reset(void){
+        memset(ata, 0, sizeof(ata));
+        memset(atb, 0, sizeof(atb));
+        n = 0;
+        scale = 0;
+    }
+
+    /** add
+    * @bref add one sample of get_magnetic_raw (or get_magnetic) without correction.
+    */
+    void add(float x, float y, float z){
+        if(scale == 0){
+            /* fixed normalization keeps the sums near 1 */
+            float r = sqrtf(x * x + y * y + z * z);
+            if(r == 0 || r < min_magnitude) return;
+            scale = 1.0f / r;
+        }
+        double u = x * scale, v = y * scale, w = z * scale;
+        double row[PARAMS] = {u * u, v * v, w * w, 2 * u * v, 2 * u * w, 2 * v * w, 2 * u, 2 * v, 2 * w};
+        for(int i = 0; i < PARAMS; i++){
+            for(int j = i; j < PARAMS; j++) ata[i][j] = ata[i][j] * forget + row[i] * row[j];
+            atb[i] = atb[i] * forget + row[i];
+        }
+        n++;
+    }
+    void add(const JY901_Type::JY_Raw_3D &raw){ add(raw.x, raw.y, raw.z); }
+    void add(const JY901_Type::JY_Dim_3D &m){ add(m.x, m.y, m.z); }
+
+    /** solve
+    * @bref fit the ellipsoid with the samples so far.
+    * @param ret : correction. Untouched on failure.
+    * @return false with too few samples, or when the samples don't span an ellipsoid
+    *         (EX rotated only around one axis).
+    */
+    bool solve(JY_Mag_Correction *ret) const {
+        if(n < (unsigned long)min_samples) return false;
+        double p[PARAMS];
+        if(!solve_normal(p)) return false;
+
+        double a[3][3] = {{p[0], p[3], p[4]}, {p[3], p[1], p[5]}, {p[4], p[5], p[2]}};
+        double inv[3][3];
+        if(!invert3(a, inv)) return false;
+        double center[3];
+        for(int i = 0; i < 3; i++) center[i] = -(inv[i][0] * p[6] + inv[i][1] * p[7] + inv[i][2] * p[8]);
+        double k = 1;
+        for(int i = 0; i < 3; i++){
+            for(int j = 0; j < 3; j++) k += center[i] * a[i][j] * center[j];
+        }
+        if(k <= 0) return false;
+
+        /* (v - center)' (a / k) (v - center) = 1, matrix = radius * sqrt(a / k) */
+        double vec[3][3], val[3];
+        for(int i = 0; i < 3; i++){
+            for(int j = 0; j < 3; j++) vec[i][j] = a[i][j] / k;
+        }
+        eigen3(vec, val);
+        if(val[0] <= 0 || val[1] <= 0 || val[2] <= 0) return false;
+        double radius = pow(val[0] * val[1] * val[2], -1.0 / 6);
+        for(int i = 0; i < 3; i++){
+            for(int j = 0; j < 3; j++){
+                double s = 0;
+                for(int e = 0; e < 3; e++) s += vec[i][e] * sqrt(val[e]) * vec[j][e];
+                ret->matrix[i * 3 + j] = (float)(radius * s);
+            }
+            ret->offset[i] = (float)(center[i] / scale);
+        }
+        return true;
+    }
+
+    /** number of added samples */
+    unsigned long get_samples(void) const { return n; }
+
+private:
+    /* Gaussian elimination with partial pivoting of ata * p = atb */
+    bool solve_normal(double *p) const {
+        double m[PARAMS][PARAMS + 1];
+        for(int i = 0; i < PARAMS; i++){
+            for(int j = 0; j < PARAMS; j++) m[i][j] = i <= j ? ata[i][j] : ata[j][i];
+            m[i][PARAMS] = atb[i];
+        }
+        for(int c = 0; c < PARAMS; c++){
+            int pivot = c;
+            for(int r = c + 1; r < PARAMS; r++) if(fabs(m[r][c]) > fabs(m[pivot][c])) pivot = r;
+            if(fabs(m[pivot][c]) < 1e-12 * (fabs(m[0][0]) + 1e-300)) return false;
+            if(pivot != c){
+                for(int j = c; j <= PARAMS; j++){
+                    double t = m[c][j]; m[c][j] = m[pivot][j]; m[pivot][j] = t;
+                }
+            }
+            for(int r = c + 1; r < PARAMS; r++){
+                double f = m[r][c] / m[c][c];
+                for(int j = c; j <= PARAMS; j++) m[r][j] -= f * m[c][j];
+            }
+        }
+        for(int r = PARAMS - 1; r >= 0; r--){
+            double s = m[r][PARAMS];
+            for(int j = r + 1; j < PARAMS; j++) s -= m[r][j] * p[j];
+            p[r] = s / m[r][r];
+        }
+        return true;
+    }
+
+    static bool invert3(const double a[3][3], double inv[3][3]){
+        double det = a[0][0] * (a[1][1] * a[2][2] - a[1][2] * a[2][1])
+                   - a[0][1] * (a[1][0] * a[2][2] - a[1][2] * a[2][0])
+                   + a[0][2] * (a[1][0] * a[2][1] - a[1][1] * a[2][0]);
+        if(det == 0) return false;
+        for(int i = 0; i < 3; i++){
+            for(int j = 0; j < 3; j++){
+                int i1 = (j + 1) % 3, i2 = (j + 2) % 3;
+                int j1 = (i + 1) % 3, j2 = (i + 2) % 3;
+                inv[i][j] = (a[i1][j1] * a[i2][j2] - a[i1][j2] * a[i2][j1]) / det;
+            }
+        }
+        return true;
+    }
+
+    /* Jacobi eigen decomposition of symmetric m. Eigen vectors are returned in columns of m. */
+    static void eigen3(double m[3][3], double val[3]){
+        double v[3][3] = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+        for(int sweep = 0; sweep < 16; sweep++){
+            double off = fabs(m[0][1]) + fabs(m[0][2]) + fabs(m[1][2]);
+            if(off < 1e-15 * (fabs(m[0][0]) + fabs(m[1][1]) + fabs(m[2][2]))) break;
+            for(int p = 0; p < 2; p++){
+                for(int q = p + 1; q < 3; q++){
+                    if(m[p][q] == 0) continue;
+                    double theta = (m[q][q] - m[p][p]) / (2 * m[p][q]);
+                    double t = (theta >= 0 ? 1 : -1) / (fabs(theta) + sqrt(theta * theta + 1));
+                    double c = 1 / sqrt(t * t + 1), s = t * c;
+                    for(int k = 0; k < 3; k++){
+                        double mkp = m[k][p], mkq = m[k][q];
+                        m[k][p] = c * mkp - s * mkq;
+                        m[k][q] = s * mkp + c * mkq;
+                    }
+                    for(int k = 0; k < 3; k++){
+                        double mpk = m[p][k], mqk = m[q][k];
+                        m[p][k] = c * mpk - s * mqk;
+                        m[q][k] = s * mpk + c * mqk;
+                    }
+                    for(int k = 0; k < 3; k++){
+                        double vkp = v[k][p], vkq = v[k][q];
+                        v[k][p] = c * vkp - s * vkq;
+                        v[k][q] = s * vkp + c * vkq;
+                    }
+                }
+            }
+        }
+        for(int i = 0; i < 3; i++){
+            val[i] = m[i][i];
+            for(int j = 0; j < 3; j++) m[i][j] = v[i][j];
+        }
+    }
+
+    float forget;
+    int min_samples;
+    float min_magnitude;
+    double ata[PARAMS][PARAMS];
+    double atb[PARAMS];
+    unsigned long n;
+    float scale;
+};
@@ -0,0 +1,120 @@
+#pragma once
+#include "jy901-type.hpp"
+#include "jy901-registers.hpp"
+
+/** @file
+ *
+ * Read planner for JY901 partial reads.
+ */
+
+/** JY901_Read_Plan Class
+ * Converts a JY_Field bit mask into the fewest contiguous register ranges.
+ * Neighbouring ranges are merged when the gap between them is not longer than
+ * merge_gap_regs registers, because reading a few unused bytes is cheaper than
+ * another START + address + subaddress + repeated START + address sequence.
+ */
+class JY901_Read_Plan
+{
+public:
+    typedef struct{
+        char addr;
+        char regs;
+    } Range;
+
+    /** constructor
+    * @bref Create an empty plan.
+    * @param merge_gap_regs : the longest gap (in registers) that is read through instead of splitting.
+    */
+    JY901_Read_Plan(int merge_gap_regs = 2)
+        : mask(0), count(0), gap(merge_gap_regs) {}
+
+    /** build
+    * @bref compute ranges for a field mask.
+    * @param field_mask : OR of JY901_Type::JY_Field.
+    * @remarks Nothing is recomputed when field_mask is same as the cached one.
+    */
+    void build(unsigned int field_mask){
+        field_mask &= JY901_Type::JY_FIELD_ALL;
+        if(field_mask == mask && (count || !field_mask)) return;
+        mask  = field_mask;
+        count = 0;
+        for(int i = 0; i < JY901_Type::JY_FIELD_COUNT; i++){
+            if(!(field_mask & (1u << i))) continue;
+            char addr = field_addr(i);
+            char regs = field_regs(i);
+            if(count){
+                Range *last = &ranges[count - 1];
+                int end = last->addr + last->regs;
+                if(addr - end <= gap){
+                    last->regs = (char)(addr + regs - last->addr);
+                    continue;
+                }
+            }
+            ranges[count].addr = addr;
+            ranges[count].regs = regs;
+            count++;
+        }
+    }
+
+    /** set_merge_gap
+    * @bref change merge rule. The cached plan is invalidated.
+    */
+    void set_merge_gap(int merge_gap_regs){
+        gap   = merge_gap_regs;
+        mask  = 0;
+        count = 0;
+    }
+
+    unsigned int get_mask(void) const { return mask; }
+    int get_count(void) const { return count; }
+    const Range &get_range(int i) const { return ranges[i]; }
+
+    /** get_bytes
+    * @bref total bytes transfered by the plan.
+    */
+    int get_bytes(void) const {
+        int bytes = 0;
+        for(int i = 0; i < count; i++) bytes += ranges[i].regs * 2;
+        return bytes;
+    }
+
+    /** field_addr
+    * @bref first register of a field.
+    * @param field_index : bit number of JY901_Type::JY_Field.
+    */
+    static char field_addr(int field_index){
+        using namespace JY901_Reg;
+        static const char addr[JY901_Type::JY_FIELD_COUNT] = {
+            YEAR::addr, ACC_X::addr, GYRO_X::addr, MAG_X::addr, ROLL::addr,
+            TEMP::addr, D0::addr, PRESSURE::addr, LON::addr, Q0::addr
+        };
+        return addr[field_index];
+    }
+
+    /** field_regs
+    * @bref register count of a field.
+    * @param field_index : bit number of JY901_Type::JY_Field.
+    */
+    static char field_regs(int field_index){
+        using namespace JY901_Reg;
+        static const char regs[JY901_Type::JY_FIELD_COUNT] = {
+            MS::addr     + MS::regs     - YEAR::addr,
+            ACC_Z::addr  + ACC_Z::regs  - ACC_X::addr,
+            GYRO_Z::addr + GYRO_Z::regs - GYRO_X::addr,
+            MAG_Z::addr  + MAG_Z::regs  - MAG_X::addr,
+            YOW::addr    + YOW::regs    - ROLL::addr,
+            TEMP::regs,
+            D3::addr     + D3::regs     - D0::addr,
+            HEIGHT::addr + HEIGHT::regs - PRESSURE::addr,
+            LAT::addr    + LAT::regs    - LON::addr,
+            Q3::addr     + Q3::regs     - Q0::addr
+        };
+        return regs[field_index];
+    }
+
+private:
+    unsigned int mask;
+    int count;
+    int gap;
+    Range ranges[JY901_Type::JY_FIELD_COUNT];
+};
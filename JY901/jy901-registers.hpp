@@ -0,0 +1,131 @@
+#pragma once
+#include <stdint.h>
+#include "jy901-type.hpp"
+
+/** @file
+ *
+ * JY901 output register descriptors.
+ * Every getter and decoder takes address, width, signedness and scale from here.
+ */
+
+/* Output register block (time 0x30 ... quaternion 0x54), 2 bytes per register. */
+static const char JY_SNAPSHOT_ADDR       = 0x30;
+static const int  JY_SNAPSHOT_REGS       = 0x25;
+static const int  JY_SNAPSHOT_BYTES      = JY_SNAPSHOT_REGS * 2;
+/* Registers compared to detect a new output: acceleration and angular velocity (0x34 - 0x39).
+ * The time registers (0x30 - 0x33) run with the module clock, not with the outputs. */
+static const char JY_PROBE_ADDR          = 0x34;
+static const int  JY_PROBE_REGS          = 6;
+
+/* little endian bytes -> integer without char sign extension */
+inline short jy_le16(const char *b){
+    return (short)(((unsigned char)b[1] << 8) | (unsigned char)b[0]);
+}
+inline long jy_le32(const char *b){
+    uint32_t v = ((uint32_t)(unsigned char)b[3] << 24) | ((uint32_t)(unsigned char)b[2] << 16)
+               | ((uint32_t)(unsigned char)b[1] << 8)  |  (uint32_t)(unsigned char)b[0];
+    return (long)(int32_t)v;
+}
+inline short jy_le16(const unsigned char *b){ return jy_le16((const char *)b); }
+inline long  jy_le32(const unsigned char *b){ return jy_le32((const char *)b); }
+
+template <int BYTES, bool SIGNED> struct JY_Register_Raw;
+template <> struct JY_Register_Raw<1, false>{
+    typedef unsigned char type;
+    static type get(const char *b){ return (unsigned char)b[0]; }
+};
+template <> struct JY_Register_Raw<2, true>{
+    typedef short type;
+    static type get(const char *b){ return jy_le16(b); }
+};
+template <> struct JY_Register_Raw<2, false>{
+    typedef unsigned short type;
+    static type get(const char *b){ return (unsigned short)jy_le16(b); }
+};
+template <> struct JY_Register_Raw<4, true>{
+    typedef long type;
+    static type get(const char *b){ return jy_le32(b); }
+};
+
+/** JY_Register
+ * Descriptor of one output value.
+ * @param ADDR   : register address (each register is 2 bytes).
+ * @param OFFSET : byte offset in the register (1 for high byte of time registers).
+ * @param BYTES  : value size in bytes (1, 2 or 4).
+ * @param SIGNED : signedness of the value.
+ * @param Scale  : JY901_Type::JY_Scale_* converting raw value to float.
+ */
+template <int ADDR, int OFFSET, int BYTES, bool SIGNED, class Scale>
+struct JY_Register
+{
+    typedef typename JY_Register_Raw<BYTES, SIGNED>::type raw_type;
+    typedef Scale scale;
+    static const int addr   = ADDR;
+    static const int offset = OFFSET;
+    static const int bytes  = BYTES;
+    /* bytes to read from addr to get the whole value */
+    static const int span   = OFFSET + BYTES;
+    /* registers covered by the value */
+    static const int regs   = (span + 1) / 2;
+
+    /** raw value from bytes read starting at addr. */
+    static raw_type raw(const char *reg){
+        return JY_Register_Raw<BYTES, SIGNED>::get(reg + OFFSET);
+    }
+    /** raw value from a block read starting at base register. */
+    static raw_type raw_at(const char *block, int base){
+        return raw(block + (ADDR - base) * 2);
+    }
+    /** scaled value from bytes read starting at addr. */
+    static float value(const char *reg){
+        return Scale::to_float(raw(reg));
+    }
+    /** scaled value from a block read starting at base register. */
+    static float value_at(const char *block, int base){
+        return Scale::to_float(raw_at(block, base));
+    }
+};
+
+/** JY901_Reg
+ * Register table of the output block (0x30 - 0x54).
+ */
+namespace JY901_Reg {
+    using namespace JY901_Type;
+
+    typedef JY_Register<0x30, 0, 1, false, JY_Scale_Raw>              YEAR;
+    typedef JY_Register<0x30, 1, 1, false, JY_Scale_Raw>              MONTH;
+    typedef JY_Register<0x31, 0, 1, false, JY_Scale_Raw>              DAY;
+    typedef JY_Register<0x31, 1, 1, false, JY_Scale_Raw>              HOUR;
+    typedef JY_Register<0x32, 0, 1, false, JY_Scale_Raw>              MIN;
+    typedef JY_Register<0x32, 1, 1, false, JY_Scale_Raw>              SEC;
+    typedef JY_Register<0x33, 0, 2, false, JY_Scale_Raw>              MS;
+
+    typedef JY_Register<0x34, 0, 2, true,  JY_Scale_Acceleration>     ACC_X;
+    typedef JY_Register<0x35, 0, 2, true,  JY_Scale_Acceleration>     ACC_Y;
+    typedef JY_Register<0x36, 0, 2, true,  JY_Scale_Acceleration>     ACC_Z;
+    typedef JY_Register<0x37, 0, 2, true,  JY_Scale_Angular_Velocity> GYRO_X;
+    typedef JY_Register<0x38, 0, 2, true,  JY_Scale_Angular_Velocity> GYRO_Y;
+    typedef JY_Register<0x39, 0, 2, true,  JY_Scale_Angular_Velocity> GYRO_Z;
+    typedef JY_Register<0x3a, 0, 2, true,  JY_Scale_Magnetic>         MAG_X;
+    typedef JY_Register<0x3b, 0, 2, true,  JY_Scale_Magnetic>         MAG_Y;
+    typedef JY_Register<0x3c, 0, 2, true,  JY_Scale_Magnetic>         MAG_Z;
+    typedef JY_Register<0x3d, 0, 2, true,  JY_Scale_Angle>            ROLL;
+    typedef JY_Register<0x3e, 0, 2, true,  JY_Scale_Angle>            PITCH;
+    typedef JY_Register<0x3f, 0, 2, true,  JY_Scale_Angle>            YOW;
+    typedef JY_Register<0x40, 0, 2, true,  JY_Scale_Temperture>       TEMP;
+
+    typedef JY_Register<0x41, 0, 2, false, JY_Scale_Raw>              D0;
+    typedef JY_Register<0x42, 0, 2, false, JY_Scale_Raw>              D1;
+    typedef JY_Register<0x43, 0, 2, false, JY_Scale_Raw>              D2;
+    typedef JY_Register<0x44, 0, 2, false, JY_Scale_Raw>              D3;
+
+    typedef JY_Register<0x45, 0, 4, true,  JY_Scale_Raw>              PRESSURE;   /* Pa */
+    typedef JY_Register<0x47, 0, 4, true,  JY_Scale_Raw>              HEIGHT;     /* cm */
+    typedef JY_Register<0x49, 0, 4, true,  JY_Scale_Raw>              LON;
+    typedef JY_Register<0x4b, 0, 4, true,  JY_Scale_Raw>              LAT;
+
+    typedef JY_Register<0x51, 0, 2, true,  JY_Scale_Quaternion>       Q0;
+    typedef JY_Register<0x52, 0, 2, true,  JY_Scale_Quaternion>       Q1;
+    typedef JY_Register<0x53, 0, 2, true,  JY_Scale_Quaternion>       Q2;
+    typedef JY_Register<0x54, 0, 2, true,  JY_Scale_Quaternion>       Q3;
+}
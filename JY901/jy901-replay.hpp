@@ -0,0 +1,149 @@
+#pragma once
+#include "mbed.h"
+#include "jy901-sim.hpp"
+#include "jy901-frame.hpp"
+#include "jy901-log.hpp"
+
+/** @file
+ *
+ * Replay of recorded JY901 data on host.
+ * Attach JY901_Replay to SimI2C instead of JY901_Sim, then the unmodified
+ * JY901 API reads the recorded registers sample by sample.
+ */
+
+/** JY_Replay_Stage
+ * Latency of one stage over all replayed samples.
+ */
+typedef struct{
+    unsigned long count;
+    unsigned long total_us;
+    unsigned long max_us;
+} JY_Replay_Stage;
+
+/** JY901_Replay Class
+ * JY901 register model whose output registers (0x30 - 0x54) come from a
+ * JY901_Log_Reader or from an array of JY901_Frame.
+ * EX
+ *   JY901_Log_Reader log(fp);
+ *   JY901_Replay replay(&log);
+ *   i2c.attach(0x50, &replay);
+ *   replay.run([&]{ process(imu.get_acceleration()); });
+ */
+class JY901_Replay
+    :public JY901_Sim
+{
+public:
+    /** constructor
+    * @param log : recorded log. Fields which are not in the log read as 0.
+    */
+    JY901_Replay(JY901_Log_Reader *log)
+        : log(log), frames(0), timestamps(0), count(0), period_us(0) { rewind(); }
+
+    /** constructor
+    * @param frames     : recorded frames.
+    * @param timestamps : timestamp of each frame in micro sec, or 0 to space them by period_us.
+    * @param count      : number of frames.
+    * @param period_us  : interval of frames without timestamps (default is RATE_DEFAULT, 10Hz).
+    */
+    JY901_Replay(const JY901_Frame *frames, const unsigned long *timestamps, size_t count,
+                 unsigned long period_us = 100000)
+        : log(0), frames(frames), timestamps(timestamps), count(count), period_us(period_us) { rewind(); }
+
+    /** rewind
+    * @bref restart from the first sample and clear statistics.
+    */
+    void rewind(void){
+        index = 0;
+        timestamp = 0;
+        if(log) log->reset();
+        memset(&frame, 0, sizeof(frame));
+        memset(&load_stage, 0, sizeof(load_stage));
+        memset(&process_stage, 0, sizeof(process_stage));
+        elapsed_us = 0;
+    }
+
+    /** step
+    * @bref load the next sample into the registers.
+    * @return false at end of the recording.
+    */
+    bool step(void){
+        if(log){
+            if(!log->read(&timestamp, &frame)) return false;
+        }else{
+            if(index >= count) return false;
+            frame = frames[index];
+            timestamp = timestamps ? timestamps[index] : index * period_us;
+        }
+        index++;
+        write_registers(JY_SNAPSHOT_ADDR, frame.data(), JY_SNAPSHOT_BYTES);
+        return true;
+    }
+
+    /** run
+    * @bref replay every sample and call process after each one.
+    * @param process  : function object that reads the device through the JY901 API.
+    * @param realtime : true to keep the recorded intervals, false to run as fast as possible.
+    * @return number of replayed samples.
+    * @remarks Stage "load" is decoding the recording, stage "process" is process
+    *          including I2C transport and JY901 decode.
+    */
+    template <class F>
+    unsigned long run(F process, bool realtime = false){
+        uint32_t start = us_ticker_read();
+        uint32_t t = start;
+        unsigned long first = 0;
+        unsigned long n = 0;
+        while(true){
+            if(!step()) break;
+            if(!n) first = timestamp;
+            t = lap(&load_stage, t);
+            if(realtime){
+                long wait = (long)(timestamp - first) - (long)(t - start);
+                if(wait > 0) wait_us(wait);
+                t = us_ticker_read();
+            }
+            process();
+            t = lap(&process_stage, t);
+            n++;
+        }
+        elapsed_us += t - start;
+        return n;
+    }
+
+    /** timestamp of the current sample in micro sec. */
+    unsigned long get_timestamp(void) const { return timestamp; }
+    /** raw registers of the current sample. */
+    const JY901_Frame &get_frame(void) const { return frame; }
+
+    /** get_samples_per_sec
+    * @bref throughput of run, including waits in realtime mode.
+    */
+    float get_samples_per_sec(void) const {
+        return elapsed_us ? process_stage.count * 1e6f / elapsed_us : 0;
+    }
+    const JY_Replay_Stage &get_load_latency(void) const { return load_stage; }
+    const JY_Replay_Stage &get_process_latency(void) const { return process_stage; }
+
+private:
+    /* consecutive stages share the boundary reading, so the totals do not lose ticker resolution */
+    static uint32_t lap(JY_Replay_Stage *stage, uint32_t from){
+        uint32_t now = us_ticker_read();
+        uint32_t us = now - from;
+        stage->count++;
+        stage->total_us += us;
+        if(us > stage->max_us) stage->max_us = us;
+        return now;
+    }
+
+    JY901_Log_Reader *log;
+    const JY901_Frame *frames;
+    const unsigned long *timestamps;
+    size_t count;
+    unsigned long period_us;
+    size_t index;
+    unsigned long timestamp;
+    JY901_Frame frame;
+    JY_Replay_Stage load_stage;
+    JY_Replay_Stage process_stage;
+    unsigned long elapsed_us;
+};
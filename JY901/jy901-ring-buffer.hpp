@@ -0,0 +1,85 @@
+#pragma once
+
+/** @file
+ *
+ * Fixed capacity single producer / single consumer ring buffer.
+ */
+
+#if defined(__CORTEX_M)
+#define JY_RING_BARRIER() __DMB()
+#else
+#define JY_RING_BARRIER() __sync_synchronize()
+#endif
+
+/** JY_Ring_Buffer Class
+ * Lock-free and allocation-free queue for one producer (thread or ISR)
+ * and one consumer. One slot is kept empty, so N - 1 elements can be stored.
+ */
+template <typename T, int N>
+class JY_Ring_Buffer
+{
+public:
+    JY_Ring_Buffer(): head(0), tail(0) {}
+
+    /** push
+    * @bref producer side. Copy one element into the buffer.
+    * @return false when the buffer is full (element is dropped).
+    */
+    bool push(const T &value){
+        unsigned int h = head;
+        unsigned int n = next(h);
+        if(n == tail) return false;
+        buf[h] = value;
+        JY_RING_BARRIER();
+        head = n;
+        return true;
+    }
+
+    /** pop
+    * @bref consumer side. Take the oldest element.
+    * @return false when the buffer is empty.
+    */
+    bool pop(T *value){
+        unsigned int t = tail;
+        if(t == head) return false;
+        JY_RING_BARRIER();
+        *value = buf[t];
+        JY_RING_BARRIER();
+        tail = next(t);
+        return true;
+    }
+
+    /** pop
+    * @bref consumer side. Take up to max elements at once.
+    * @return number of elements copied to values.
+    */
+    int pop(T *values, int max){
+        int n = 0;
+        unsigned int t = tail;
+        unsigned int h = head;
+        JY_RING_BARRIER();
+        while(n < max && t != h){
+            values[n++] = buf[t];
+            t = next(t);
+        }
+        JY_RING_BARRIER();
+        tail = t;
+        return n;
+    }
+
+    int size(void) const {
+        unsigned int h = head;
+        unsigned int t = tail;
+        return (int)((h + N - t) % N);
+    }
+    bool empty(void) const { return head == tail; }
+    static int capacity(void) { return N - 1; }
+
+private:
+    static unsigned int next(unsigned int i){
+        return (i + 1 == (unsigned int)N) ? 0 : i + 1;
+    }
+    T buf[N];
+    volatile unsigned int head;
+    volatile unsigned int tail;
+};
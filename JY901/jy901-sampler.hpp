@@ -0,0 +1,125 @@
+#pragma once
+#include "mbed.h"
+#include "jy901.hpp"
+#include "jy901-ring-buffer.hpp"
+
+/** @file
+ *
+ * Background sampler for JY901.
+ * The sampler thread is the only user of the bus while it runs.
+ */
+
+/** JY901_Sampler Class
+ * Reads JY901 in its own RTOS thread at the rate settled by set_return_rate
+ * and pushes timestamped samples into a ring buffer of N - 1 elements.
+ * No sample is lost while the consumer drains at least every
+ * get_max_drain_interval_us() ((N - 1) * period). Otherwise new samples are dropped,
+ * and the consumer sees it by check_overflow(), which stays set until checked.
+ */
+template <int N = 64, class Device = JY901>
+class JY901_Sampler
+{
+public:
+    /** constructor
+    * @param imu        : JY901 (or JY901_T<Bus>) instance. Don't access its bus from other threads while sampling.
+    * @param field_mask : OR of JY901_Type::JY_Field to be sampled.
+    * @param priority   : priority of the sampler thread.
+    * @param stack_size : stack size of the sampler thread.
+    */
+    JY901_Sampler(Device *imu, unsigned int field_mask = JY_FIELD_ALL,
+                  osPriority priority = osPriorityHigh, uint32_t stack_size = 1024)
+        : imu(imu), mask(field_mask), period_us(0), overflows(0), overflowed(false), running(false),
+          thread(priority, stack_size) {}
+
+    /** start
+    * @bref start sampling thread.
+    * @param period : sampling period in micro sec. 0 to follow get_return_rate of imu.
+    * @remarks The thread can be started only once.
+    */
+    void start(unsigned long period = 0){
+        period_us = period ? period : Device::rate_to_period_us(imu->get_return_rate());
+        if(!period_us) period_us = Device::rate_to_period_us(RATE_DEFAULT);
+        running = true;
+        thread.start(callback(this, &JY901_Sampler::loop));
+    }
+
+    /** stop
+    * @bref stop sampling and wait for the thread.
+    */
+    void stop(void){
+        running = false;
+        thread.join();
+    }
+
+    /** read
+    * @bref drain samples from the ring buffer. Never touches the bus.
+    * @param samples : destination array.
+    * @param max     : length of samples.
+    * @return number of samples copied.
+    */
+    int read(JY_Sample *samples, int max){
+        return ring.pop(samples, max);
+    }
+
+    /** available
+    * @return number of samples waiting in the ring buffer.
+    */
+    int available(void) const {
+        return ring.size();
+    }
+
+    /** get_overflows
+    * @return number of samples dropped because the consumer didn't drain in time.
+    * @remarks Keep this 0 by choosing N larger than samples produced between drains.
+    */
+    unsigned long get_overflows(void) const {
+        return overflows;
+    }
+
+    /** check_overflow
+    * @bref sticky loss flag. Check it after read: samples before the ones read next are missing.
+    * @return true if samples were dropped since the previous call. The flag is cleared.
+    */
+    bool check_overflow(void){
+        if(!overflowed) return false;
+        overflowed = false;
+        return true;
+    }
+
+    /** get_max_drain_interval_us
+    * @return longest time between reads that loses no sample, (N - 1) * sampling period.
+    * @remarks Valid after start. Size N as rate x worst case consumer latency + 1.
+    */
+    unsigned long get_max_drain_interval_us(void) const {
+        return (unsigned long)(N - 1) * period_us;
+    }
+
+private:
+    void loop(void){
+        JY_Sample sample;
+        uint64_t next_ms = Kernel::get_ms_count();
+        unsigned long rest_us = 0;
+        while(running){
+            sample.timestamp_us = us_ticker_read();
+            imu->get_fields(mask, &sample.data);
+            if(!ring.push(sample)){
+                overflows++;
+                overflowed = true;
+            }
+
+            rest_us += period_us;
+            next_ms += rest_us / 1000;
+            rest_us %= 1000;
+            ThisThread::sleep_until(next_ms);
+        }
+    }
+
+    Device *imu;
+    unsigned int mask;
+    unsigned long period_us;
+    volatile unsigned long overflows;
+    volatile bool overflowed;
+    volatile bool running;
+    JY_Ring_Buffer<JY_Sample, N> ring;
+    Thread thread;
+};
@@ -0,0 +1,157 @@
+#pragma once
+#include "mbed.h"
+#include "jy901.hpp"
+#include "jy901-ring-buffer.hpp"
+
+/** @file
+ *
+ * Bus scheduler for several JY901 on one I2C bus.
+ *
+ * Create one JY901_Bus_Scheduler per bus and call service() of every scheduler
+ * from the main loop. With DEVICE_I2C_ASYNCH each scheduler keeps one transfer
+ * running on its bus, so devices on different I2C peripherals are read in parallel.
+ */
+
+/** JY901_Bus_Scheduler Class
+ * Reads registered devices in earliest deadline first order.
+ * Devices with the same period are read round robin.
+ * @param Device : JY901_T<Bus> type of the devices.
+ * @param N      : max number of devices on the bus.
+ */
+template <class Device = JY901, int N = 4>
+class JY901_Bus_Scheduler
+{
+public:
+    JY901_Bus_Scheduler(): n(0), busy(-1) {}
+
+    /** add
+    * @bref register a device on this bus.
+    * @param dev        : device. Don't access it directly while scheduled.
+    * @param period_us  : read period in micro sec.
+    * @param field_mask : OR of JY901_Type::JY_Field to be read.
+    * @return device id, or -1 if the scheduler is full.
+    */
+    int add(Device *dev, unsigned long period_us, unsigned int field_mask = JY_FIELD_ALL){
+        if(n >= N) return -1;
+        Entry &e   = entries[n];
+        e.owner    = this;
+        e.dev      = dev;
+        e.mask     = field_mask;
+        e.period   = period_us;
+        e.deadline = us_ticker_read();
+#if DEVICE_I2C_ASYNCH
+        dev->attach_async_error(Callback<void(int)>(&e, &Entry::on_error));
+#endif
+        return n++;
+    }
+
+    /** service
+    * @bref start (or with blocking bus, do) the read of the most urgent due device.
+    * @return true if a read was started.
+    */
+    bool service(void){
+        if(busy >= 0) return false;
+        uint32_t now = us_ticker_read();
+        int pick = -1;
+        for(int i = 0; i < n; i++){
+            if((int32_t)(now - entries[i].deadline) < 0) continue;
+            if(pick < 0 || (int32_t)(entries[i].deadline - entries[pick].deadline) < 0) pick = i;
+        }
+        if(pick < 0) return false;
+
+        Entry &e = entries[pick];
+        e.release  = e.deadline;
+        e.deadline += e.period;
+        while((int32_t)(now - e.deadline) >= 0){
+            e.deadline += e.period;
+            e.missed++;
+        }
+#if DEVICE_I2C_ASYNCH
+        busy = pick;
+        if(!e.dev->get_fields_async(e.mask, Callback<void(const JY_Snapshot&)>(&e, &Entry::on_done))) return true;
+        busy = -1;
+#endif
+        JY_Snapshot data;
+        e.dev->get_fields(e.mask, &data);
+        e.store(data);
+        return true;
+    }
+
+    /** read
+    * @bref copy latest data of a device.
+    * @param id           : device id returned by add.
+    * @param data         : destination.
+    * @param timestamp_us : us_ticker_read() when the read finished (optional).
+    * @return true if the data is new since last read.
+    */
+    bool read(int id, JY_Snapshot *data, uint32_t *timestamp_us = 0){
+        Entry &e = entries[id];
+        unsigned int seq;
+        do{
+            seq = e.seq;
+            JY_RING_BARRIER();
+            *data = e.data;
+            if(timestamp_us) *timestamp_us = e.stamp;
+            JY_RING_BARRIER();
+        }while((seq & 1) || seq != e.seq);
+        bool fresh = seq != e.read_seq;
+        e.read_seq = seq;
+        return fresh;
+    }
+
+    int get_count(void) const { return n; }
+    /** number of periods skipped because the bus was too busy. */
+    unsigned long get_missed(int id) const { return entries[id].missed; }
+    /** number of failed reads. */
+    unsigned long get_errors(int id) const { return entries[id].errors; }
+    /** worst time from scheduled release to data in micro sec. */
+    uint32_t get_max_latency_us(int id) const { return entries[id].max_latency; }
+
+private:
+    class Entry
+    {
+    public:
+        Entry(): seq(0), read_seq(0), stamp(0), missed(0), errors(0), max_latency(0) {
+            memset(&data, 0, sizeof(data));
+        }
+
+        /* publishes the fields of mask only, the others keep their last value (0 before the first read) */
+        void store(const JY_Snapshot &d){
+            uint32_t now = us_ticker_read();
+            seq++;
+            JY_RING_BARRIER();
+            Device::copy_fields(d, &data, mask);
+            stamp = now;
+            JY_RING_BARRIER();
+            seq++;
+            if(now - release > max_latency) max_latency = now - release;
+        }
+        void on_done(const JY_Snapshot &d){
+            store(d);
+            owner->busy = -1;
+        }
+        void on_error(int event){
+            (void)event;
+            errors++;
+            owner->busy = -1;
+        }
+
+        JY901_Bus_Scheduler *owner;
+        Device *dev;
+        unsigned int mask;
+        unsigned long period;
+        uint32_t deadline;
+        uint32_t release;
+        volatile unsigned int seq;
+        unsigned int read_seq;
+        JY_Snapshot data;
+        uint32_t stamp;
+        unsigned long missed;
+        unsigned long errors;
+        uint32_t max_latency;
+    };
+
+    Entry entries[N];
+    int n;
+    volatile int busy;
+};
@@ -0,0 +1,206 @@
+#pragma once
+#include "mbed.h"
+#include "jy901-type.hpp"
+#include "jy901-registers.hpp"
+#include "jy901-ring-buffer.hpp"
+
+/** @file
+ *
+ * JY901 UART streaming mode.
+ * Enabled by "#define JY901_SERIAL" before including jy901.hpp,
+ * or include this header alone when only the UART is used.
+ *
+ * The module streams 11 byte packets:
+ * 0x55, type(0x50 - 0x5A), 8 data bytes, checksum (sum of first 10 bytes).
+ */
+
+#ifndef JY901_SERIAL_BUFFER
+#define JY901_SERIAL_BUFFER 256
+#endif
+
+static const char JY_SERIAL_HEADER      = 0x55;
+static const int  JY_SERIAL_PACKET_SIZE = 11;
+
+/** JY901_Serial Class
+ * Receives packets into a circular buffer from the RX interrupt
+ * and decodes them in place. The first JY_SERIAL_PACKET_SIZE - 1 bytes of the
+ * buffer are mirrored behind its end, so every packet is contiguous in memory
+ * and never copied.
+ */
+class JY901_Serial
+{
+public:
+    /** constructor
+    * @bref Create an instance from the address of RawSerial instance.
+    * @param port : serial port connected to the module. Baud rate has to be settled by caller.
+    */
+    JY901_Serial(RawSerial *port)
+        : serial(port), head(0), tail(0), checksum_errors(0), overflows(0), updated(0) {
+        memset(&latest, 0, sizeof(latest));
+        serial->attach(callback(this, &JY901_Serial::on_rx), SerialBase::RxIrq);
+    }
+
+    /** poll
+    * @bref decode every complete packet received so far.
+    * @return OR of JY901_Type::JY_Field updated by this call.
+    */
+    unsigned int poll(void){
+        unsigned int fields = 0;
+        unsigned int t = tail;
+        for(;;){
+            unsigned int h = head;
+            while(t != h && rx[t] != JY_SERIAL_HEADER) t = next(t, 1);
+            if(count(t, h) < JY_SERIAL_PACKET_SIZE) break;
+            const char *packet = &rx[t];
+            if(!valid(packet)){
+                checksum_errors++;
+                t = next(t, 1);
+                continue;
+            }
+            fields |= decode(packet, &latest);
+            t = next(t, JY_SERIAL_PACKET_SIZE);
+        }
+        JY_RING_BARRIER();
+        tail = t;
+        updated |= fields;
+        return fields;
+    }
+
+    /** get_snapshot
+    * @bref latest decoded values of every packet type.
+    */
+    const JY901_Type::JY_Snapshot &get_snapshot(void) const { return latest; }
+
+    /** take_updated
+    * @bref OR of JY_Field updated since the last call.
+    */
+    unsigned int take_updated(void){
+        unsigned int ret = updated;
+        updated = 0;
+        return ret;
+    }
+
+    JY901_Type::JY_Time                  get_time(void)                  const { return latest.time; }
+    JY901_Type::JY_Dim_3D                get_acceleration(void)          const { return latest.acceleration; }
+    JY901_Type::JY_Dim_3D                get_angular_velocity(void)      const { return latest.angular_velocity; }
+    JY901_Type::JY_Dim_3D                get_magnetic(void)              const { return latest.magnetic; }
+    JY901_Type::JY_Pitch_Angle           get_pitch_angle(void)           const { return latest.angle; }
+    float                                get_temperture(void)            const { return latest.temperture; }
+    JY901_Type::JY_Pin_Status            get_pin_status(void)            const { return latest.pin_status; }
+    JY901_Type::JY_Pressure_Height       get_pressure_height(void)       const { return latest.pressure_height; }
+    JY901_Type::JY_Geographical_Position get_geographical_position(void) const { return latest.position; }
+    JY901_Type::JY_Quaternion            get_quaternion(void)            const { return latest.quaternion; }
+
+    unsigned long get_checksum_errors(void) const { return checksum_errors; }
+    unsigned long get_overflows(void) const { return overflows; }
+
+    /** valid
+    * @bref check header and checksum of an 11 byte packet.
+    */
+    static bool valid(const char *packet){
+        unsigned char sum = 0;
+        if(packet[0] != JY_SERIAL_HEADER) return false;
+        for(int i = 0; i < JY_SERIAL_PACKET_SIZE - 1; i++) sum += (unsigned char)packet[i];
+        return sum == (unsigned char)packet[JY_SERIAL_PACKET_SIZE - 1];
+    }
+
+    /** decode
+    * @bref decode one valid packet into ret.
+    * @return JY_Field updated, 0 for unknown packet type.
+    */
+    static unsigned int decode(const char *packet, JY901_Type::JY_Snapshot *ret){
+        const unsigned char *d = (const unsigned char *)&packet[2];
+        switch((unsigned char)packet[1]){
+        case 0x50:
+            ret->time.year  = 2000 + d[0];
+            ret->time.month = d[1];
+            ret->time.day   = d[2];
+            ret->time.hour  = d[3];
+            ret->time.min   = d[4];
+            ret->time.sec   = d[5];
+            ret->time.ms    = jy_le16(&d[6]);
+            return JY901_Type::JY_FIELD_TIME;
+        case 0x51:
+            ret->acceleration.x    = JY901_Type::JY_Scale_Acceleration::to_float(jy_le16(&d[0]));
+            ret->acceleration.y    = JY901_Type::JY_Scale_Acceleration::to_float(jy_le16(&d[2]));
+            ret->acceleration.z    = JY901_Type::JY_Scale_Acceleration::to_float(jy_le16(&d[4]));
+            ret->acceleration.temp = JY901_Type::JY_Scale_Temperture::to_float(jy_le16(&d[6]));
+            ret->temperture        = ret->acceleration.temp;
+            return JY901_Type::JY_FIELD_ACCELERATION | JY901_Type::JY_FIELD_TEMPERTURE;
+        case 0x52:
+            ret->angular_velocity.x    = JY901_Type::JY_Scale_Angular_Velocity::to_float(jy_le16(&d[0]));
+            ret->angular_velocity.y    = JY901_Type::JY_Scale_Angular_Velocity::to_float(jy_le16(&d[2]));
+            ret->angular_velocity.z    = JY901_Type::JY_Scale_Angular_Velocity::to_float(jy_le16(&d[4]));
+            ret->angular_velocity.temp = JY901_Type::JY_Scale_Temperture::to_float(jy_le16(&d[6]));
+            return JY901_Type::JY_FIELD_ANGULAR_VELOCITY;
+        case 0x53:
+            ret->angle.roll  = JY901_Type::JY_Scale_Angle::to_float(jy_le16(&d[0]));
+            ret->angle.pitch = JY901_Type::JY_Scale_Angle::to_float(jy_le16(&d[2]));
+            ret->angle.yow   = JY901_Type::JY_Scale_Angle::to_float(jy_le16(&d[4]));
+            return JY901_Type::JY_FIELD_ANGLE;
+        case 0x54:
+            ret->magnetic.x    = jy_le16(&d[0]);
+            ret->magnetic.y    = jy_le16(&d[2]);
+            ret->magnetic.z    = jy_le16(&d[4]);
+            ret->magnetic.temp = JY901_Type::JY_Scale_Temperture::to_float(jy_le16(&d[6]));
+            return JY901_Type::JY_FIELD_MAGNETIC;
+        case 0x55:
+            ret->pin_status.P0 = jy_le16(&d[0]);
+            ret->pin_status.P1 = jy_le16(&d[2]);
+            ret->pin_status.P2 = jy_le16(&d[4]);
+            ret->pin_status.P3 = jy_le16(&d[6]);
+            return JY901_Type::JY_FIELD_PIN_STATUS;
+        case 0x56:
+            ret->pressure_height.pressure = jy_le32(&d[0]);
+            ret->pressure_height.height   = jy_le32(&d[4]);
+            return JY901_Type::JY_FIELD_PRESSURE_HEIGHT;
+        case 0x57:
+            ret->position.longitude = jy_le32(&d[0]);
+            ret->position.latitude  = jy_le32(&d[4]);
+            return JY901_Type::JY_FIELD_POSITION;
+        case 0x59:
+            ret->quaternion.quat0 = JY901_Type::JY_Scale_Quaternion::to_float(jy_le16(&d[0]));
+            ret->quaternion.quat1 = JY901_Type::JY_Scale_Quaternion::to_float(jy_le16(&d[2]));
+            ret->quaternion.quat2 = JY901_Type::JY_Scale_Quaternion::to_float(jy_le16(&d[4]));
+            ret->quaternion.quat3 = JY901_Type::JY_Scale_Quaternion::to_float(jy_le16(&d[6]));
+            return JY901_Type::JY_FIELD_QUATERNION;
+        default:
+            return 0;
+        }
+    }
+
+private:
+    static unsigned int next(unsigned int i, int n){
+        i += n;
+        return i >= JY901_SERIAL_BUFFER ? i - JY901_SERIAL_BUFFER : i;
+    }
+    static int count(unsigned int t, unsigned int h){
+        return (int)((h + JY901_SERIAL_BUFFER - t) % JY901_SERIAL_BUFFER);
+    }
+
+    /* RX interrupt: store byte and mirror the beginning of the buffer behind its end. */
+    void on_rx(void){
+        while(serial->readable()){
+            char c = serial->getc();
+            unsigned int h = head;
+            unsigned int n = next(h, 1);
+            if(n == tail){
+                overflows++;
+                continue;
+            }
+            rx[h] = c;
+            if(h < JY_SERIAL_PACKET_SIZE - 1) rx[JY901_SERIAL_BUFFER + h] = c;
+            JY_RING_BARRIER();
+            head = n;
+        }
+    }
+
+    RawSerial *serial;
+    char rx[JY901_SERIAL_BUFFER + JY_SERIAL_PACKET_SIZE - 1];
+    volatile unsigned int head;
+    volatile unsigned int tail;
+    unsigned long checksum_errors;
+    volatile unsigned long overflows;
+    unsigned int updated;
+    JY901_Type::JY_Snapshot latest;
+};
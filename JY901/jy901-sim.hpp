@@ -0,0 +1,178 @@
+#pragma once
+#include <string.h>
+#include "mbed.h"
+#include "sim-i2c.hpp"
+#include "jy901-type.hpp"
+
+/** @file
+ *
+ * JY901 register map model for SimI2C.
+ */
+
+static const int JY_SIM_REGS = 0x60;
+
+/** JY901_Sim Class
+ * Register file 0x00 - 0x5F of 16bit little endian registers.
+ * Master writes subaddress then data, reads auto-increment from subaddress.
+ * With set_output_timing it also models a running module on us_ticker_read time.
+ */
+class JY901_Sim
+    :public SimI2C_Device
+{
+public:
+    JY901_Sim(): ptr(0), saves(0), writes(0), timed(false), period_us(0), conversion_us(0),
+                 t0(0), period_index(0), single_pending(false), single_at(0), outputs(0), output_us(0) {
+        memset(mem, 0, sizeof(mem));
+        set_register(0x03, JY901_Type::RATE_DEFAULT);
+        set_register(0x1a, 0x50);
+    }
+
+    virtual void i2c_write(char data, bool first){
+        if(first){
+            tick();
+            ptr = ((unsigned char)data % JY_SIM_REGS) * 2;
+            return;
+        }
+        mem[ptr] = data;
+        if(!(ptr & 1)) on_register_write(ptr >> 1);
+        ptr = (ptr + 1) % sizeof(mem);
+    }
+
+    virtual char i2c_read(void){
+        char c = mem[ptr];
+        ptr = (ptr + 1) % sizeof(mem);
+        return c;
+    }
+
+    /** set_register
+    * @bref set a register as if the module updated it.
+    */
+    void set_register(int reg, short value){
+        mem[reg * 2]     = (char)(value & 0xFF);
+        mem[reg * 2 + 1] = (char)((value >> 8) & 0xFF);
+    }
+
+    short get_register(int reg) const {
+        return (short)(((unsigned char)mem[reg * 2 + 1] << 8) | (unsigned char)mem[reg * 2]);
+    }
+
+    /** write_registers
+    * @bref copy raw little endian bytes starting at reg (EX a recorded 0x30 - 0x54 block).
+    */
+    void write_registers(int reg, const char *bytes, int length){
+        if(reg * 2 + length > (int)sizeof(mem)) length = sizeof(mem) - reg * 2;
+        memcpy(&mem[reg * 2], bytes, length);
+    }
+
+    /* helpers to set output registers from raw values */
+    void set_acceleration(short x, short y, short z){ set3(0x34, x, y, z); }
+    void set_angular_velocity(short x, short y, short z){ set3(0x37, x, y, z); }
+    void set_magnetic(short x, short y, short z){ set3(0x3a, x, y, z); }
+    void set_angle(short roll, short pitch, short yow){ set3(0x3d, roll, pitch, yow); }
+    void set_temperture(short centi_degree){ set_register(0x40, centi_degree); }
+    void set_quaternion(short q0, short q1, short q2, short q3){
+        set3(0x51, q0, q1, q2);
+        set_register(0x54, q3);
+    }
+    void set_pressure_height(long pa, long cm){ set32(0x45, pa); set32(0x47, cm); }
+    void set_position(long longitude, long latitude){ set32(0x49, longitude); set32(0x4b, latitude); }
+    void set_time(char year, char month, char day, char hour, char min, char sec, short ms){
+        set_register(0x30, (short)(((unsigned char)month << 8) | (unsigned char)year));
+        set_register(0x31, (short)(((unsigned char)hour << 8) | (unsigned char)day));
+        set_register(0x32, (short)(((unsigned char)sec << 8) | (unsigned char)min));
+        set_register(0x33, ms);
+    }
+
+    /** set_output_timing
+    * @bref model the module output on us_ticker_read time.
+    * @param period     : output period in micro sec while the rate register (0x03) isn't RATE_SINGLE, 0 for none.
+    * @param conversion : delay in micro sec of the output after RATE_SINGLE is written to 0x03.
+    * @remarks The time registers (0x30 - 0x33) run with the clock at every transfer.
+    *          Acceleration and angular velocity change only at an output, to the output count.
+    */
+    void set_output_timing(unsigned long period, unsigned long conversion){
+        timed          = true;
+        period_us      = period;
+        conversion_us  = conversion;
+        t0             = us_ticker_read();
+        period_index   = 0;
+        single_pending = false;
+        output_us      = t0;
+        output();
+    }
+
+    /** number of outputs made by the set_output_timing model */
+    unsigned long get_output_count(void) const { return outputs; }
+    /** us_ticker_read time of the last output */
+    uint32_t get_output_us(void) const { return output_us; }
+
+    /** get_save_count
+    * @bref number of SAVE (0x00) commands, i.e. flash writes of the real module.
+    */
+    unsigned long get_save_count(void) const { return saves; }
+    /** get_write_count
+    * @bref number of registers written by master (counted at low byte).
+    */
+    unsigned long get_write_count(void) const { return writes; }
+
+private:
+    void set3(int reg, short a, short b, short c){
+        set_register(reg, a);
+        set_register(reg + 1, b);
+        set_register(reg + 2, c);
+    }
+    void set32(int reg, long value){
+        set_register(reg, (short)(value & 0xFFFF));
+        set_register(reg + 1, (short)((value >> 16) & 0xFFFF));
+    }
+    void on_register_write(int reg){
+        writes++;
+        if(reg == 0x00 && mem[0] == 0x00) saves++;
+        if(reg == 0x03 && mem[6] == JY901_Type::RATE_SINGLE && timed){
+            single_pending = true;
+            single_at      = us_ticker_read() + conversion_us;
+        }
+    }
+
+    /* bring clock and outputs up to now */
+    void tick(void){
+        if(!timed) return;
+        uint32_t now = us_ticker_read();
+        uint32_t ms  = (now - t0) / 1000;
+        set_time(20, 1, 1, (char)(ms / 3600000 % 24), (char)(ms / 60000 % 60), (char)(ms / 1000 % 60),
+                 (short)(ms % 1000));
+        if(single_pending && (int32_t)(now - single_at) >= 0){
+            single_pending = false;
+            output_us = single_at;
+            output();
+        }
+        if(period_us && mem[6] != JY901_Type::RATE_SINGLE){
+            uint32_t k = (now - t0) / period_us;
+            if(k != period_index){
+                period_index = k;
+                output_us    = t0 + k * period_us;
+                output();
+            }
+        }
+    }
+
+    void output(void){
+        outputs++;
+        set_acceleration((short)outputs, (short)(outputs >> 16), 0);
+        set_angular_velocity(0, 0, (short)-outputs);
+    }
+
+    char mem[JY_SIM_REGS * 2];
+    unsigned int ptr;
+    unsigned long saves;
+    unsigned long writes;
+    bool timed;
+    unsigned long period_us;
+    unsigned long conversion_us;
+    uint32_t t0;
+    uint32_t period_index;
+    bool single_pending;
+    uint32_t single_at;
+    unsigned long outputs;
+    uint32_t output_us;
+};
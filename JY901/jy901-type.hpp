@@ -39,13 +39,101 @@ namespace JY901_Type{
         } JY_Pin_Status;
 
         typedef struct{
-            struct{
+            union{
+                struct{
                     float quat0, quat1, quat2, quat3;
+                };
+                float quat[4];
             };
-            float quat[4];
         } JY_Quaternion;
 
+        typedef struct{
+            short x, y, z;
+        } JY_Raw_3D;
+
+        typedef struct{
+            short q[4];
+        } JY_Raw_Quaternion;
+
+        typedef struct{
+            JY_Time                  time;
+            JY_Dim_3D                acceleration;
+            JY_Dim_3D                angular_velocity;
+            JY_Dim_3D                magnetic;
+            JY_Pitch_Angle           angle;
+            float                    temperture;
+            JY_Pin_Status            pin_status;
+            JY_Pressure_Height       pressure_height;
+            JY_Geographical_Position position;
+            JY_Quaternion            quaternion;
+        } JY_Snapshot;
+
+        typedef struct{
+            unsigned long timestamp_us;
+            JY_Snapshot   data;
+        } JY_Sample;
+
     }
+    /* Scale of raw register values.
+     * to_float : value in float unit of the getters.
+     * to_q16   : same value in Q16.16 fixed point, (raw * Q16_MUL) >> Q16_SHIFT in 32bit.
+     */
+    struct JY_Scale_Raw{                   /* register value as is */
+        template <typename T> static float to_float(T raw){ return (float)raw; }
+    };
+    struct JY_Scale_Acceleration{          /* m/s^2 */
+        static const long Q16_MUL   = 20070;   /* 16 * 9.8 / 32768 * 2^16 * 2^6 */
+        static const int  Q16_SHIFT = 6;
+        static float to_float(short raw){ return raw / 32768.0f * 16 * 9.8f; }
+        static long  to_q16(short raw){ return ((long)raw * Q16_MUL) >> Q16_SHIFT; }
+    };
+    struct JY_Scale_Angular_Velocity{      /* deg/s */
+        static const long Q16_MUL   = 4000;    /* 2000 / 32768 * 2^16 */
+        static const int  Q16_SHIFT = 0;
+        static float to_float(short raw){ return raw / 32768.0f * 2000; }
+        static long  to_q16(short raw){ return ((long)raw * Q16_MUL) >> Q16_SHIFT; }
+    };
+    struct JY_Scale_Magnetic{              /* raw unit */
+        static const long Q16_MUL   = 65536;
+        static const int  Q16_SHIFT = 0;
+        static float to_float(short raw){ return raw; }
+        static long  to_q16(short raw){ return ((long)raw * Q16_MUL) >> Q16_SHIFT; }
+    };
+    struct JY_Scale_Angle{                 /* rad */
+        static const long Q16_MUL   = 12868;   /* pi / 32768 * 2^16 * 2^11 */
+        static const int  Q16_SHIFT = 11;
+        static float to_float(short raw){ return raw / 32768.0f * 3.1415926535897932384626f; }
+        static long  to_q16(short raw){ return ((long)raw * Q16_MUL) >> Q16_SHIFT; }
+    };
+    struct JY_Scale_Temperture{            /* degree */
+        static const long Q16_MUL   = 41943;   /* 1 / 100 * 2^16 * 2^6 */
+        static const int  Q16_SHIFT = 6;
+        static float to_float(short raw){ return raw / 100.0f; }
+        static long  to_q16(short raw){ return ((long)raw * Q16_MUL) >> Q16_SHIFT; }
+    };
+    struct JY_Scale_Quaternion{            /* raw is Q15 */
+        static const long Q16_MUL   = 2;
+        static const int  Q16_SHIFT = 0;
+        static float to_float(short raw){ return raw / 32768.0f; }
+        static long  to_q16(short raw){ return ((long)raw * Q16_MUL) >> Q16_SHIFT; }
+    };
+
+    /* Field bits for partial reads. Bit order follows register address order. */
+    typedef enum{
+        JY_FIELD_TIME             = 1 << 0,
+        JY_FIELD_ACCELERATION     = 1 << 1,
+        JY_FIELD_ANGULAR_VELOCITY = 1 << 2,
+        JY_FIELD_MAGNETIC         = 1 << 3,
+        JY_FIELD_ANGLE            = 1 << 4,
+        JY_FIELD_TEMPERTURE       = 1 << 5,
+        JY_FIELD_PIN_STATUS       = 1 << 6,
+        JY_FIELD_PRESSURE_HEIGHT  = 1 << 7,
+        JY_FIELD_POSITION         = 1 << 8,
+        JY_FIELD_QUATERNION       = 1 << 9,
+        JY_FIELD_COUNT            = 10,
+        JY_FIELD_ALL              = (1 << 10) - 1
+    } JY_Field;
+
     typedef enum{
         RATE_HZ01 = 0x01,
         RATE_HZ05 = 0x02,
@@ -85,4 +173,19 @@ namespace JY901_Type{
         JY_PIN_MODE_DEFAULT = 0x00
     } JY_Pin_Mode;
 
+    /* CALSW (0x01) values */
+    typedef enum{
+        JY_CAL_NONE         = 0x00,
+        JY_CAL_GYRO_ACC     = 0x01,
+        JY_CAL_MAGNETIC     = 0x02,
+        JY_CAL_HEIGHT       = 0x03
+    } JY_Calibration_Mode;
+
+    typedef enum{
+        JY_CAL_IDLE,
+        JY_CAL_RUNNING,
+        JY_CAL_DONE,
+        JY_CAL_CANCELLED
+    } JY_Calibration_State;
+
 }
\ No newline at end of file
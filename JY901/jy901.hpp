@@ -1,13 +1,18 @@
 #pragma once
 #include "my-i2c.hpp"
 #include "jy901-type.hpp"
+#include "jy901-registers.hpp"
+#include "jy901-read-plan.hpp"
+#include "jy901-frame.hpp"
+#include "jy901-mag-calibration.hpp"
 
 /** @file
  *
  * JY901 library.
  *
  * To use with UART, 
- * insert "#define JY901_SERIAL" before include.
+ * insert "#define JY901_SERIAL" before include
+ * and use JY901_Serial class (jy901-serial.hpp).
  */
 #ifndef M_PI_F
 #define M_PI_F 3.1415926535897932384626f
@@ -16,6 +21,11 @@
 static const char JY_ADDR                = 0x50;
 static const char JY_901_DEFAULT_CONTENT = 0x8F;
 
+/* Configuration registers 0x00 - 0x1F kept in the write-through shadow. */
+static const int  JY_CONFIG_REGS         = 0x20;
+/* Longest calibration duration the 32bit micro sec us_ticker can measure (about 71 minutes). */
+static const unsigned long JY_CAL_MAX_DURATION_MS = 0xFFFFFFFFul / 1000;
+
 
 
 
@@ -28,9 +38,11 @@ using namespace JY901_Type;
 
 /** JY901 Class
  * This is the JY901 9 axis sensors library class.
+ * JY901 is JY901_T<I2C>. Use JY901_T<Bus> with other bus policy (EX JY901_T<SimI2C>).
  */
-class JY901 
-    :public MyI2C
+template <class Bus = I2C>
+class JY901_T 
+    :public MyI2C_T<Bus>
 {
 public:
     /** constructor 
@@ -38,14 +50,14 @@ public:
     * @remarks  Slave address is automatically settled 0x50.
     * @param bus : Pointer of I2C Instance (or Serial Instance).
     */
-    JY901(I2C *bus): MyI2C(bus, JY_ADDR) {}
+    JY901_T(Bus *bus): MyI2C_T<Bus>(bus, JY_ADDR) {}
 
     /** constructor 
     * @bref Create an instance from the address of I2C intance and I2C Address.
     * @param bus     :  Pointer of I2C Instance (or Serial Instance).
     * @param address :  Slave address number that you settled before.
     */
-    JY901(I2C *bus,  char address): MyI2C(bus, address) {}
+    JY901_T(Bus *bus,  char address): MyI2C_T<Bus>(bus, address) {}
     
 
     /** set_default_setting
@@ -54,6 +66,36 @@ public:
     void set_default_setting(){
         char cmd[2] = {0x01, 0x00};
         this->write(0x00, cmd, 2);
+        invalidate_shadow();
+    }
+
+    /** defer_settings
+     * @bref hold save_settings of set_led, set_serial_baudrate and set_new_i2c_address <br>until commit_settings.
+     * @param defer : true to hold, false to save on every call (default).
+     * @remarks Holding saves all changes with one flash write of the module.
+     */
+    void defer_settings(bool defer){
+        defer_save = defer;
+        if(!defer) commit_settings();
+    }
+
+    /** commit_settings
+     * @bref save changed settings to the module with one save_settings.
+     * @return true if settings were saved, false if nothing changed.
+     */
+    bool commit_settings(void){
+        if(!settings_dirty) return false;
+        save_settings();
+        settings_dirty = false;
+        return true;
+    }
+
+    /** invalidate_shadow
+     * @bref forget cached configuration registers. Next set_* call always writes.
+     * @remarks Call this after the module was reset or configured by someone else.
+     */
+    void invalidate_shadow(void){
+        shadow_valid = 0;
     }
 
 
@@ -61,29 +103,20 @@ public:
      * @bref start gyroscope calibration mode 
      * @param interval_ms : wait interval_ms in this method <br>and exit carlibration automatically.
      * @remarks If you abbreviate parametor or set parametor to zero,<br> you should call exit_calibration method 
+     * @remarks Use start_carlibration not to block the thread.
      */
     void enter_gyroscope_carlibration(int interval_ms = 0){
-        char cmd[2] = {0x01, 0x00};
-        this->write(0x01, cmd, 2);
-        if(!interval_ms){
-            wait_ms(interval_ms);
-            exit_carlibration();
-        }
+        enter_carlibration(JY_CAL_GYRO_ACC, interval_ms);
     }
 
     /**  enter_magnetic_calibration
      * @bref start magnetic calibration mode 
      * @param interval_ms : wait interval_ms in this method <br>and exit carlibration automatically.
      * @remarks If you abbreviate parametor or set parametor to zero,<br> you should call exit_calibration method 
+     * @remarks Use start_carlibration not to block the thread.
      */
     void enter_magnetic_carlibration(int interval_ms = 0){
-        char cmd[2] = {0x02, 0x00};
-        this->write(0x01, cmd, 2);
-
-         if(!interval_ms){
-            wait_ms(interval_ms);
-            exit_carlibration();
-        }
+        enter_carlibration(JY_CAL_MAGNETIC, interval_ms);
     }
 
     /**  enter_height_calibration
@@ -91,14 +124,10 @@ public:
      * @param interval_ms : wait interval_ms in this method <br>and exit carlibration automatically.
      * @remarks This is unique function of JY901B <br>(or other series that has baromator)
      * @remarks If you abbreviate parametor or set parametor to zero, <br>you should call exit_calibration method 
+     * @remarks Use start_carlibration not to block the thread.
      */
     void enter_height_carlibration(int interval_ms = 0){
-        char cmd[2] = {0x03, 0x00};
-        this->write(0x01, cmd, 2);
-        if(!interval_ms){
-            wait_ms(interval_ms);
-            exit_carlibration();
-        }
+        enter_carlibration(JY_CAL_HEIGHT, interval_ms);
     }
 
     /** exit_carlibration
@@ -106,8 +135,58 @@ public:
      * @remarks You don't have to call this function <br>if you call enter carlibration method with parametor.
      */
     void exit_carlibration(void){
-        char cmd[2] = {0x03, 0x00};
-        this->write(0x01, cmd, 2);
+        write_carlibration(JY_CAL_NONE);
+        if(cal_state == JY_CAL_RUNNING) cal_state = JY_CAL_DONE;
+    }
+
+    /** start_carlibration
+     * @bref start calibration without blocking.
+     * @param mode        : JY_CAL_GYRO_ACC, JY_CAL_MAGNETIC or JY_CAL_HEIGHT.
+     * @param duration_ms : poll_carlibration exits calibration after this. 0 to run until cancel_carlibration.
+     *                      Up to JY_CAL_MAX_DURATION_MS.
+     * @return false if a calibration is already running or duration_ms is too long.
+     * @remarks Call poll_carlibration periodically (EX from EventQueue::call_every), <br>
+     *          at least once per JY_CAL_MAX_DURATION_MS. <br>
+     *          It writes to the bus, so don't call it from interrupt context (Ticker).
+     */
+    bool start_carlibration(JY_Calibration_Mode mode, unsigned long duration_ms = 0){
+        if(cal_state == JY_CAL_RUNNING) return false;
+        if(duration_ms > JY_CAL_MAX_DURATION_MS) return false;
+        write_carlibration(mode);
+        cal_mode        = mode;
+        cal_start       = us_ticker_read();
+        cal_duration_us = (uint32_t)duration_ms * 1000;
+        cal_state       = JY_CAL_RUNNING;
+        return true;
+    }
+
+    /** poll_carlibration
+     * @bref exit calibration when its duration passed.
+     * @return state after polling. JY_CAL_DONE and JY_CAL_CANCELLED stay until the next start.
+     */
+    JY_Calibration_State poll_carlibration(void){
+        if(cal_state == JY_CAL_RUNNING && cal_duration_us
+            && us_ticker_read() - cal_start >= cal_duration_us){
+            exit_carlibration();
+        }
+        return cal_state;
+    }
+
+    /** cancel_carlibration
+     * @bref exit a running calibration now.
+     */
+    void cancel_carlibration(void){
+        if(cal_state != JY_CAL_RUNNING) return;
+        write_carlibration(JY_CAL_NONE);
+        cal_state = JY_CAL_CANCELLED;
+    }
+
+    JY_Calibration_State get_carlibration_state(void) const { return cal_state; }
+    /** mode of the last started calibration */
+    JY_Calibration_Mode get_carlibration_mode(void) const { return cal_mode; }
+    /** elapsed time of the running calibration in milli sec, 0 when not running. */
+    unsigned long get_carlibration_elapsed_ms(void) const {
+        return cal_state == JY_CAL_RUNNING ? (us_ticker_read() - cal_start) / 1000 : 0;
     }
 
 /**
@@ -119,9 +198,68 @@ public:
      * @remark You have to select parametor form JY_Sampling_Rate enum. <br>(EX 200Hz. JY901_Type::RATE_HZ200)
      */
     void set_return_rate(JY_Sampling_Rate rate){
-        char cmd[2] = {(char)rate, 0x00};
-        this->write(0x03, cmd, 2);
+        write_config(0x03, (unsigned short)rate);
+        return_rate = rate;
+    }
+
+    /** get_return_rate
+     * @bref sample speed last settled by set_return_rate.
+     * @remarks RATE_DEFAULT until set_return_rate is called.
+     */
+    JY_Sampling_Rate get_return_rate(void) const {
+        return return_rate;
+    }
+
+    /** rate_to_period_us
+     * @bref output period of a sampling rate.
+     * @return period in micro sec, 0 for RATE_SINGLE and RATE_NOT_OUTPUT.
+     */
+    static unsigned long rate_to_period_us(JY_Sampling_Rate rate){
+        static const unsigned long period[] = {
+            0, 10000000, 2000000, 1000000, 500000, 200000,
+            100000, 50000, 20000, 10000, 5000
+        };
+        if(rate < RATE_HZ01 || rate > RATE_HZ200) return 0;
+        return period[rate];
+    }
+
+    /** acquire_single
+     * @bref trigger one output with RATE_SINGLE, wait for it and read selected fields.
+     * @param field_mask : OR of JY901_Type::JY_Field.
+     * @param ret        : destination. Fields not in field_mask are left untouched.
+     * @param timeout_us : give up waiting for the output after this.
+     * @param poll_us    : interval of checking acceleration and angular velocity (JY_PROBE_ADDR) for the new output.
+     * @return trigger-to-data latency in micro sec, -1 on timeout, -2 when the trigger was not acknowledged.
+     * @remarks The output is detected by a change of the probed registers, not by the time
+     *          registers, which run with the module clock. <br>
+     *          The module stays idle in RATE_SINGLE until the next trigger. <br>
+     *          Call set_return_rate to go back to continuous output.
+     */
+    long acquire_single(unsigned int field_mask, JY_Snapshot *ret,
+                        unsigned long timeout_us = 100000, unsigned long poll_us = 200){
+        char before[JY_PROBE_REGS * 2], buff[JY_PROBE_REGS * 2];
+        this->read(JY_PROBE_ADDR, before, sizeof(before));
+        /* RATE_SINGLE is a trigger, write it even if the register already holds it */
+        if(!write_config(0x03, (unsigned short)RATE_SINGLE, true)) return -2;
+        return_rate = RATE_SINGLE;
+        uint32_t start = us_ticker_read();
+        do{
+            if(us_ticker_read() - start >= timeout_us) return -1;
+            wait_us(poll_us);
+            this->read(JY_PROBE_ADDR, buff, sizeof(buff));
+        }while(!memcmp(buff, before, sizeof(buff)));
+        get_fields(field_mask, ret);
+        single_latency = us_ticker_read() - start;
+        if(single_latency > single_latency_max) single_latency_max = single_latency;
+        return single_latency;
     }
+
+    /** get_single_latency_us
+     * @bref trigger-to-data latency of the last acquire_single in micro sec.
+     */
+    uint32_t get_single_latency_us(void) const { return single_latency; }
+    /** worst trigger-to-data latency of acquire_single in micro sec. */
+    uint32_t get_single_latency_max_us(void) const { return single_latency_max; }
    
    /** set_serial_baudrate
     * @bref set serial baundrate
@@ -129,9 +267,7 @@ public:
     * @remarks After re-power ,it will take effect.
     */
     void set_serial_baudrate(JY_Serial_Baud rate){
-        char cmd[2] = {(char)rate, 0x00};
-        this->write(0x01, cmd, 2);
-        save_settings();
+        if(write_config(0x04, (unsigned short)rate)) request_save();
     }
 
 /**
@@ -144,8 +280,8 @@ public:
     * @param pin_mode : pin mode , select form JY_Pin_Mode enum <br>(EX Anolog Input. JY901_Type::JY_ANALOG)
     */
      void set_pin_mode (int pin_ID, JY_Pin_Mode pin_mode){
-        if(pin_ID > 3) return;
-        this->write( (char)(0x0e + pin_ID), (char)pin_mode);
+        if(pin_ID < 0 || pin_ID > 3) return;
+        write_config((char)(0x0e + pin_ID), (unsigned short)pin_mode);
     }
 
   
@@ -156,8 +292,8 @@ public:
     * @remarks : Distinction of 1/0 is done with lower 1 bit.
     */
     void set_pin_write(int pin_ID, int state){
-        if(pin_ID > 3) return;
-        this->write( (char)(0x0e + pin_ID), (char)(0x10|(state&1)));
+        if(pin_ID < 0 || pin_ID > 3) return;
+        write_config((char)(0x0e + pin_ID), (unsigned short)(0x10|(state&1)));
     }
 
    /** set_pwm_width
@@ -166,12 +302,8 @@ public:
     * @param high_width_us    : length pin out high voltage in micro sec
     */
     void set_pwm_width (int pin_ID, unsigned short high_width_us){
-        char dum[2];
-        if(pin_ID > 3) return;
-
-        dum[0] = high_width_us & 0x00FF;
-        dum[1] = high_width_us >> 8;
-        this->write( (char)(0x12 + pin_ID), dum, 2);
+        if(pin_ID < 0 || pin_ID > 3) return;
+        write_config((char)(0x12 + pin_ID), high_width_us);
     }
 
    /** set_pwm_power
@@ -181,7 +313,7 @@ public:
     * @remarks This is third pirson Method. Even if this dosn't work well, There is NO warranty. <br>I recommend you to use set_pwm_width method.
     */
     void set_pwm_power (int pin_ID, float duty_rate){
-        if(pin_ID > 3) return;
+        if(pin_ID < 0 || pin_ID > 3) return;
         if(duty_rate < 0) duty_rate = 0;
         if(duty_rate > 1) duty_rate = 1;
         set_pwm_width(pin_ID, (unsigned short)(duty_rate * periods[pin_ID]));
@@ -193,15 +325,43 @@ public:
     * @param period_us    : pwm period length
     */
     void set_pwm_period (int pin_ID, unsigned short period_us){
-        char dum[2];
-        if(pin_ID > 3) return;
-
-        dum[0] = period_us & 0x00FF;
-        dum[1] = period_us >> 8;
-        this->write( (char)(0x16 + pin_ID), dum, 2);
+        if(pin_ID < 0 || pin_ID > 3) return;
+        write_config((char)(0x16 + pin_ID), period_us);
         periods[pin_ID] = period_us;
     }
 
+   /** set_pwm_widths
+    * @bref set pwm width length of all 4 pins in one burst write.
+    * @param high_width_us : length pin out high voltage in micro sec, index is pin number.
+    */
+    void set_pwm_widths (const unsigned short high_width_us[4]){
+        write_config_block(0x12, high_width_us, 4);
+    }
+
+   /** set_pwm_powers
+    * @bref set pwm duty rate of all 4 pins in one burst write.
+    * @param duty_rate : setting duty rate in range 0 to 1, index is pin number.
+    */
+    void set_pwm_powers (const float duty_rate[4]){
+        unsigned short widths[4];
+        for(int i = 0; i < 4; i++){
+            float d = duty_rate[i];
+            if(d < 0) d = 0;
+            if(d > 1) d = 1;
+            widths[i] = (unsigned short)(d * periods[i]);
+        }
+        set_pwm_widths(widths);
+    }
+
+   /** set_pwm_periods
+    * @bref set pwm period length of all 4 pins in one burst write.
+    * @param period_us : pwm period length, index is pin number.
+    */
+    void set_pwm_periods (const unsigned short period_us[4]){
+        write_config_block(0x16, period_us, 4);
+        for(int i = 0; i < 4; i++) periods[i] = period_us[i];
+    }
+
    /** set_new_i2c_address
     *  @bref set new slave ID
     *  @param new I2C address (7bit)
@@ -210,9 +370,7 @@ public:
     *  @remarks Resotre setting -> short D2 to VCC and power on
     */
     void set_new_i2c_address(char new_address){
-        char cmd[2] = { new_address, 0x00};
-        this->write(0x01, cmd, 2);
-        this->save_settings();
+        if(write_config(0x1a, (unsigned char)new_address)) request_save();
     }
 
    /** set_led
@@ -221,12 +379,7 @@ public:
     *  @remarks After re-power ,it will take effect.
     */
     void set_led(bool state){
-        if(state){
-            this->write(0x1b, 0x00);
-        }else{
-            this->write(0x1b, 0x01);
-        }
-        this->save_settings();
+        if(write_config(0x1b, state ? 0x00 : 0x01)) request_save();
     }
 
 
@@ -234,16 +387,17 @@ public:
     /** get_pressure_height
      * @bref Get Pressure and Height form barometor
      * @return JY901_Type::JY_Pressure_Height
-     * @retval .pressure can get float pressure.
-     * @retval .height can get float heigth. 
+     * @retval .pressure can get float pressure in Pa.
+     * @retval .height can get float heigth in cm. 
      * @remarks This is unique function of JY901B (or other series that has baromator)
      */
     JY_Pressure_Height get_pressure_height(void){
-        char buff[9];
+        MY_I2C_STATS_API("JY901::get_pressure_height");
+        char buff[8];
         JY_Pressure_Height height_state;
-        this->read(0x45, buff, 9); 
-        height_state.pressure = ( buff[3]<<24)| ( buff[2]<<16)| ( buff[1]<<8)| buff[0]; 
-        height_state.height   = ( buff[7]<<24)| ( buff[6]<<16)| ( buff[5]<<8)| buff[4]; 
+        this->read(JY901_Reg::PRESSURE::addr, buff, 8);
+        height_state.pressure = JY901_Reg::PRESSURE::value_at(buff, JY901_Reg::PRESSURE::addr);
+        height_state.height   = JY901_Reg::HEIGHT::value_at(buff, JY901_Reg::PRESSURE::addr);
         return height_state;  
     }
     
@@ -260,16 +414,11 @@ public:
      * @remarks If there are no GPS <br> time of the module will be set January 1, 2015 0:00'00"00 when power on.
      */
     JY_Time get_time(void){
+        MY_I2C_STATS_API("JY901::get_time");
         JY_Time ret ;
-        char buff[9];
-        this->read(0x30, buff, 9);
-        ret.year = 2000 + buff[0];
-        ret.month = buff[1];
-        ret.day = buff[2];
-        ret.hour = buff[3];
-        ret.min = buff[4];
-        ret.sec = buff[5];
-        ret.ms = (buff[7] << 8) | buff[6];
+        char buff[8];
+        this->read(JY901_Reg::YEAR::addr, buff, 8);
+        decode_time(buff, JY901_Reg::YEAR::addr, &ret);
         return ret;
     }
 
@@ -284,13 +433,8 @@ public:
      *  @retval .data can get as float array which has 3 length.
     */
     JY_Dim_3D get_acceleration(void){
-        JY_Dim_3D ret;
-        char buff[6];
-        this->read(0x34, buff, 6);
-        ret.x       = ((buff[1]<< 8 ) | buff[0] ) / 32768.0f * 16 * 9.8f;
-        ret.y       = ((buff[3]<< 8 ) | buff[2] ) / 32768.0f * 16 * 9.8f;
-        ret.z       = ((buff[5]<< 8 ) | buff[4] ) / 32768.0f * 16 * 9.8f;
-        return ret;
+        MY_I2C_STATS_API("JY901::get_acceleration");
+        return to_dim_3d<JY_Scale_Acceleration>(get_acceleration_raw());
     }
 
     /** 
@@ -300,9 +444,7 @@ public:
      *  @remarks When you need 3 axis data get_acceleration is better in terms of speed.
     */
     float get_acceleration_x(void){
-        char buff[2];
-        this->read(0x34, buff, 2);
-        return ((buff[1]<< 8 ) | buff[0] )/ 32768.0f * 16 * 9.8f;
+        return get<JY901_Reg::ACC_X>();
     }
 
     /** 
@@ -312,9 +454,7 @@ public:
      *  @remarks When you need 3 axis data get_acceleration is better in terms of speed.
     */
     float get_acceleration_y(void){
-        char buff[2];
-        this->read(0x35, buff, 2);
-        return ((buff[1]<< 8 ) | buff[0] )/ 32768.0f * 16 * 9.8f;
+        return get<JY901_Reg::ACC_Y>();
     }
 
     /** 
@@ -324,9 +464,7 @@ public:
      *  @remarks When you need 3 axis data get_acceleration is better in terms of speed.
     */
     float get_acceleration_z(void){
-        char buff[2];
-        this->read(0x36, buff, 2); 
-        return ((buff[1]<< 8 ) | buff[0] )/ 32768.0f * 16 * 9.8f;
+        return get<JY901_Reg::ACC_Z>();
     }
 
     /** 
@@ -339,13 +477,8 @@ public:
      *  @retval .data can get as float array which has 3 length.
     */
     JY_Dim_3D get_angular_velocity(void){
-        JY_Dim_3D ret;
-        char buff[6];
-        this->read(0x37, buff, 6);
-        ret.x   = ((buff[1]<< 8 ) | buff[0] ) / 32768.0f * 2000;
-        ret.y   = ((buff[3]<< 8 ) | buff[2] ) / 32768.0f * 2000;
-        ret.z   = ((buff[5]<< 8 ) | buff[4] ) / 32768.0f * 2000;
-        return ret;
+        MY_I2C_STATS_API("JY901::get_angular_velocity");
+        return to_dim_3d<JY_Scale_Angular_Velocity>(get_angular_velocity_raw());
     }
 
     /** 
@@ -355,9 +488,7 @@ public:
      *  @remarks When you need 3 axis data get_angular_velocity is better in terms of speed.
      */
     float get_angular_velocity_x(void){
-        char buff[2];
-        this->read(0x37, buff, 2);
-        return ((buff[1]<< 8 ) | buff[0] )/ 32768.0f * 2000;
+        return get<JY901_Reg::GYRO_X>();
     }
 
    /** 
@@ -367,9 +498,7 @@ public:
      *  @remarks When you need 3 axis data get_angular_velocity is better in terms of speed.
      */
     float get_angular_velocity_y(void){
-        char buff[2];
-        this->read(0x38, buff, 2);
-        return ((buff[1]<< 8 ) | buff[0] )/ 32768.0f * 2000;
+        return get<JY901_Reg::GYRO_Y>();
     }
 
    /** 
@@ -379,9 +508,7 @@ public:
      *  @remarks When you need 3 axis data get_angular_velocity is better in terms of speed.
      */
     float get_angular_velocity_z(void){
-        char buff[2];
-        this->read(0x39, buff, 2);
-        return ((buff[1]<< 8 ) | buff[0] )/ 32768.0f * 2000;
+        return get<JY901_Reg::GYRO_Z>();
     }
 
 
@@ -395,12 +522,9 @@ public:
      *  @retval .data can get as float array which has 3 length.
     */
     JY_Dim_3D get_magnetic(void){
-        JY_Dim_3D ret;
-        char buff[6];
-        this->read(0x3a, buff, 6);
-        ret.x       = ((buff[1]<< 8 ) | buff[0] );
-        ret.y       = ((buff[3]<< 8 ) | buff[2] );
-        ret.z       = ((buff[5]<< 8 ) | buff[4] );
+        MY_I2C_STATS_API("JY901::get_magnetic");
+        JY_Dim_3D ret = to_dim_3d<JY_Scale_Magnetic>(get_magnetic_raw());
+        if(mag_correction) mag_correction->apply(&ret);
         return ret;
     }
    /** 
@@ -408,11 +532,10 @@ public:
      *  @bref get x-axis magnetic
      *  @return x-axis magnetic in float
      *  @remarks When you need 3 axis data get_magnetic is better in terms of speed.
+     *  @remarks set_magnetic_correction is not applied.
      */
     float get_magnetic_x(void){
-        char buff[2];
-        this->read(0x3a, buff, 2);
-        return ((buff[1]<< 8 ) | buff[0] );
+        return get<JY901_Reg::MAG_X>();
     }
 
        /** 
@@ -420,11 +543,10 @@ public:
      *  @bref get y-axis magnetic
      *  @return y-axis magnetic in float
      *  @remarks When you need 3 axis data get_magnetic is better in terms of speed.
+     *  @remarks set_magnetic_correction is not applied.
      */
     float get_magnetic_y(void){
-        char buff[2];
-        this->read(0x3b, buff, 2);
-        return ((buff[1]<< 8 ) | buff[0] );
+        return get<JY901_Reg::MAG_Y>();
     }
 
    /** 
@@ -432,11 +554,10 @@ public:
      *  @bref get z-axis magnetic
      *  @return z-axis magnetic in float
      *  @remarks When you need 3 axis data get_magnetic is better in terms of speed.
+     *  @remarks set_magnetic_correction is not applied.
      */
     float get_magnetic_z(void){
-        char buff[2];
-        this->read(0x3c, buff, 2);
-        return ((buff[1]<< 8 ) | buff[0] );
+        return get<JY901_Reg::MAG_Z>();
     }
 
 
@@ -449,12 +570,12 @@ public:
      *  @retval .yow can get yow anggle in float.
     */
     JY_Pitch_Angle get_pitch_angle(void){
+        MY_I2C_STATS_API("JY901::get_pitch_angle");
         JY_Pitch_Angle angle_state;
-        char buff[6];
-        this->read(0x3D, buff, 6);
-        angle_state.roll     = ((buff[1]<< 8 ) | buff[0] ) / 32768.0f * M_PI_F;
-        angle_state.pitch    = ((buff[3]<< 8 ) | buff[2] ) / 32768.0f * M_PI_F;
-        angle_state.yow      = ((buff[5]<< 8 ) | buff[4] ) / 32768.0f * M_PI_F;
+        JY_Raw_3D raw = get_pitch_angle_raw();
+        angle_state.roll     = JY_Scale_Angle::to_float(raw.x);
+        angle_state.pitch    = JY_Scale_Angle::to_float(raw.y);
+        angle_state.yow      = JY_Scale_Angle::to_float(raw.z);
         return angle_state;
     }
    /** 
@@ -465,11 +586,10 @@ public:
      * @param yow is float pointer that save yow angle value.
     */
     void get_pitch_angle(float *roll, float *pitch, float *yow){
-        char buff[6];
-        this->read(0x3D, buff, 6);
-        *roll     = ((buff[1]<< 8 ) | buff[0] ) / 32768.0f * M_PI_F;
-        *pitch    = ((buff[3]<< 8 ) | buff[2] ) / 32768.0f * M_PI_F;
-        *yow      = ((buff[5]<< 8 ) | buff[4] ) / 32768.0f * M_PI_F;        
+        JY_Raw_3D raw = get_pitch_angle_raw();
+        *roll     = JY_Scale_Angle::to_float(raw.x);
+        *pitch    = JY_Scale_Angle::to_float(raw.y);
+        *yow      = JY_Scale_Angle::to_float(raw.z);
     }
 
    /** 
@@ -479,9 +599,7 @@ public:
      *  @remarks When you need all of pitch angle data get_pitch_angle is better in terms of speed.
      */
     float get_roll(void){
-        char buff[2];
-        this->read(0x3D, buff, 2);
-        return ((buff[1]<< 8 ) | buff[0] ) / 32768.0f * M_PI_F;
+        return get<JY901_Reg::ROLL>();
     }
 
    /** 
@@ -491,9 +609,7 @@ public:
      *  @remarks When you need all of pitch angle data get_pitch_angle is better in terms of speed.
      */    
     float get_pitch(void){
-        char buff[2];
-        this->read(0x3E, buff, 2);
-        return ((buff[1]<< 8 ) | buff[0] ) / 32768.0f * M_PI_F;
+        return get<JY901_Reg::PITCH>();
     }
 
    /** 
@@ -503,9 +619,7 @@ public:
      *  @remarks When you need all of pitch angle data get_pitch_angle is better in terms of speed.
      */
     float get_yow(void){
-        char buff[2];
-        this->read(0x3F, buff, 2);
-        return ((buff[1]<< 8 ) | buff[0] ) / 32768.0f * M_PI_F;
+        return get<JY901_Reg::YOW>();
     }
 
    /** 
@@ -514,9 +628,8 @@ public:
      *  @return degree temperture in float.
      */
     float get_temperture(void){
-        char buff[2];
-        this->read(0x40, buff, 2);
-        return ((buff[1]<< 8 ) | buff[0] ) / 100.0f;
+        MY_I2C_STATS_API("JY901::get_temperture");
+        return JY_Scale_Temperture::to_float(get_temperture_raw());
     }
 
     /** 
@@ -530,13 +643,11 @@ public:
      *  @retval .P  short type array store pin status that four length.
     */    
     JY_Pin_Status get_pin_status(void){
+        MY_I2C_STATS_API("JY901::get_pin_status");
         JY_Pin_Status ret;
         char buff[8];
-        this->read(0x41, buff, 8);
-        ret.P0 = ((buff[1]<< 8 ) | buff[0] );
-        ret.P1 = ((buff[3]<< 8 ) | buff[2] );
-        ret.P2 = ((buff[5]<< 8 ) | buff[4] );
-        ret.P3 = ((buff[7]<< 8 ) | buff[6] );
+        this->read(JY901_Reg::D0::addr, buff, 8);
+        decode_pin_status(buff, JY901_Reg::D0::addr, &ret);
         return ret;
     }
 
@@ -546,10 +657,10 @@ public:
      *  @return pin status in unsigned short.
     */    
     unsigned short get_pin_status(int pin_ID){
-        if(pin_ID > 3) return 0;
+        if(pin_ID < 0 || pin_ID > 3) return 0;
         char buff[2];
-        this->read((char)(0x41 + pin_ID), buff, 2);
-        return ((buff[1]<< 8 ) | buff[0] );
+        this->read((char)(JY901_Reg::D0::addr + pin_ID), buff, 2);
+        return JY901_Reg::D0::raw(buff);
     }
 
     /**
@@ -574,23 +685,542 @@ public:
      * @retval .quat  4 length array that store quaternion.
     */
     JY_Quaternion get_quaternion(void){
+        MY_I2C_STATS_API("JY901::get_quaternion");
         JY_Quaternion ret;
+        JY_Raw_Quaternion raw = get_quaternion_raw();
+        ret.quat0   = JY_Scale_Quaternion::to_float(raw.q[0]);
+        ret.quat1   = JY_Scale_Quaternion::to_float(raw.q[1]);
+        ret.quat2   = JY_Scale_Quaternion::to_float(raw.q[2]);
+        ret.quat3   = JY_Scale_Quaternion::to_float(raw.q[3]);
+        return ret;
+    }
+
+    /** 
+     * get_acceleration_raw
+     *  @bref get 3axis acceleration as register value.
+     *  @return JY901_Type::JY_Raw_3D. Scale with JY901_Type::JY_Scale_Acceleration.
+    */
+    JY_Raw_3D get_acceleration_raw(void){
+        return get_raw_3d<JY901_Reg::ACC_X, JY901_Reg::ACC_Y, JY901_Reg::ACC_Z>();
+    }
+
+    /** 
+     * get_angular_velocity_raw
+     *  @bref get 3axis angular velocity as register value.
+     *  @return JY901_Type::JY_Raw_3D. Scale with JY901_Type::JY_Scale_Angular_Velocity.
+    */
+    JY_Raw_3D get_angular_velocity_raw(void){
+        return get_raw_3d<JY901_Reg::GYRO_X, JY901_Reg::GYRO_Y, JY901_Reg::GYRO_Z>();
+    }
+
+    /** 
+     * get_magnetic_raw
+     *  @bref get 3axis magnetic as register value.
+     *  @return JY901_Type::JY_Raw_3D. Scale with JY901_Type::JY_Scale_Magnetic.
+    */
+    JY_Raw_3D get_magnetic_raw(void){
+        return get_raw_3d<JY901_Reg::MAG_X, JY901_Reg::MAG_Y, JY901_Reg::MAG_Z>();
+    }
+
+    /** 
+     * get_pitch_angle_raw
+     *  @bref get roll, pitch, yow as register value in .x, .y, .z.
+     *  @return JY901_Type::JY_Raw_3D. Scale with JY901_Type::JY_Scale_Angle.
+    */
+    JY_Raw_3D get_pitch_angle_raw(void){
+        return get_raw_3d<JY901_Reg::ROLL, JY901_Reg::PITCH, JY901_Reg::YOW>();
+    }
+
+    /** 
+     * get_temperture_raw
+     *  @bref get temperture as register value (1/100 degree).
+    */
+    short get_temperture_raw(void){
+        return get_raw<JY901_Reg::TEMP>();
+    }
+
+    /** 
+     * get_quaternion_raw
+     *  @bref get quaternion as register value (Q15).
+     *  @return JY901_Type::JY_Raw_Quaternion.
+    */
+    JY_Raw_Quaternion get_quaternion_raw(void){
+        JY_Raw_Quaternion ret;
         char buff[8];
-        this->read(0x51, buff, 8);
-        ret.quat0   = ((buff[1]<< 8 ) | buff[0] ) / 32768.0f;
-        ret.quat1   = ((buff[3]<< 8 ) | buff[2] ) / 32768.0f;
-        ret.quat2   = ((buff[5]<< 8 ) | buff[4] ) / 32768.0f;
-        ret.quat3   = ((buff[7]<< 8 ) | buff[6] ) / 32768.0f;
+        this->read(JY901_Reg::Q0::addr, buff, 8);
+        ret.q[0] = JY901_Reg::Q0::raw_at(buff, JY901_Reg::Q0::addr);
+        ret.q[1] = JY901_Reg::Q1::raw_at(buff, JY901_Reg::Q0::addr);
+        ret.q[2] = JY901_Reg::Q2::raw_at(buff, JY901_Reg::Q0::addr);
+        ret.q[3] = JY901_Reg::Q3::raw_at(buff, JY901_Reg::Q0::addr);
+        return ret;
+    }
+
+    /** 
+     * get
+     *  @bref read one value described in JY901_Reg (EX get<JY901_Reg::ACC_X>()).
+     *  @return scaled value in float.
+    */
+    template <class Reg>
+    float get(void){
+        char buff[Reg::span];
+        this->read(Reg::addr, buff, Reg::span);
+        return Reg::value(buff);
+    }
+
+    /** 
+     * get_raw
+     *  @bref read one value described in JY901_Reg as register value.
+    */
+    template <class Reg>
+    typename Reg::raw_type get_raw(void){
+        char buff[Reg::span];
+        this->read(Reg::addr, buff, Reg::span);
+        return Reg::raw(buff);
+    }
+
+    /** 
+     * get_raw_3d
+     *  @bref read three contiguous values described in JY901_Reg in one burst.
+    */
+    template <class X, class Y, class Z>
+    JY_Raw_3D get_raw_3d(void){
+        static_assert(Y::addr == X::addr + X::regs && Z::addr == Y::addr + Y::regs, "registers must be contiguous");
+        JY_Raw_3D ret;
+        char buff[(X::regs + Y::regs + Z::regs) * 2];
+        this->read(X::addr, buff, sizeof(buff));
+        ret.x = X::raw_at(buff, X::addr);
+        ret.y = Y::raw_at(buff, X::addr);
+        ret.z = Z::raw_at(buff, X::addr);
         return ret;
     }
 
+    /** 
+     * to_dim_3d
+     *  @bref scale raw 3axis value to float.
+     *  @param Scale : JY901_Type::JY_Scale_* of the value.
+    */
+    template <class Scale>
+    static JY_Dim_3D to_dim_3d(const JY_Raw_3D &raw){
+        JY_Dim_3D ret;
+        ret.x = Scale::to_float(raw.x);
+        ret.y = Scale::to_float(raw.y);
+        ret.z = Scale::to_float(raw.z);
+        return ret;
+    }
+
+    /** 
+     * set_magnetic_correction
+     * @bref apply hard / soft iron correction to magnetic of get_magnetic, get_snapshot, get_fields and async reads.
+     * @param correction : kept by the caller and read on every decode (EX updated by JY901_Mag_Calibrator::solve), 0 to disable.
+    */
+    void set_magnetic_correction(const JY_Mag_Correction *correction){
+        mag_correction = correction;
+    }
+
+    /** 
+     * get_snapshot
+     * @bref get every output register (0x30 - 0x54) in one burst read.
+     * @return JY901_Type::JY_Snapshot.
+     * @retval .time, .acceleration, .angular_velocity, .magnetic, .angle
+     * @retval .temperture, .pin_status, .pressure_height, .position, .quaternion
+     * @remarks One bus transaction instead of one per getter. <br>Use this when you need more than two kinds of data.
+    */
+    JY_Snapshot get_snapshot(void){
+        MY_I2C_STATS_API("JY901::get_snapshot");
+        JY_Snapshot ret;
+        JY901_Frame frame;
+        get_frame(&frame);
+        decode_snapshot(frame.data(), &ret);
+        if(mag_correction) mag_correction->apply(&ret.magnetic);
+        return ret;
+    }
+
+    /** 
+     * get_frame
+     * @bref burst read every output register (0x30 - 0x54) into a raw frame.
+     * @param frame : destination. The bus writes directly into it, nothing is decoded.
+     * @remarks Decode only what you need with frame accessors (EX frame.get_acceleration()).
+    */
+    void get_frame(JY901_Frame *frame){
+        MY_I2C_STATS_API("JY901::get_frame");
+        this->read(JY_SNAPSHOT_ADDR, frame->data(), JY_SNAPSHOT_BYTES);
+    }
+
+    /** 
+     * get_frame_fields
+     * @bref read only selected fields into a raw frame with the fewest burst reads.
+     * @param field_mask : OR of JY901_Type::JY_Field.
+     * @param frame      : destination. Registers not in field_mask are left untouched.
+    */
+    void get_frame_fields(unsigned int field_mask, JY901_Frame *frame){
+        MY_I2C_STATS_API("JY901::get_frame_fields");
+        plan.build(field_mask);
+        for(int i = 0; i < plan.get_count(); i++){
+            const JY901_Read_Plan::Range &r = plan.get_range(i);
+            this->read(r.addr, frame->at(r.addr), r.regs * 2);
+        }
+    }
+
+    /** 
+     * get_fields
+     * @bref read only selected fields with the fewest burst reads.
+     * @param field_mask : OR of JY901_Type::JY_Field (EX JY_FIELD_ACCELERATION | JY_FIELD_ANGLE).
+     * @param ret        : destination. Fields not in field_mask are left untouched.
+     * @remarks The read plan is cached, so calling with the same mask costs no planning.
+    */
+    void get_fields(unsigned int field_mask, JY_Snapshot *ret){
+        MY_I2C_STATS_API("JY901::get_fields");
+        JY901_Frame frame;
+        get_frame_fields(field_mask, &frame);
+        decode_snapshot(frame.data(), ret, field_mask);
+        if(mag_correction && (field_mask & JY_FIELD_MAGNETIC)) mag_correction->apply(&ret->magnetic);
+    }
+
+#if DEVICE_I2C_ASYNCH
+    /** 
+     * get_fields_async
+     * @bref start non-blocking read of selected fields.
+     * @param field_mask : OR of JY901_Type::JY_Field.
+     * @param done       : called with decoded data when the burst read finished.
+     * @return 0 on success, -1 if a transfer is already running.
+     * @remarks The fields are read with one burst from the first to the last selected register.
+     * @remarks Callbacks are called from interrupt context. <br>Set error callback with attach_async_error.
+    */
+    int get_fields_async(unsigned int field_mask, Callback<void(const JY_Snapshot&)> done){
+        if(async_busy) return -1;
+        async_field       = 0;
+        async_snapshot_cb = done;
+        return start_async(field_mask);
+    }
+
+    /** 
+     * get_snapshot_async
+     * @bref start non-blocking read of every output register in one burst.
+    */
+    int get_snapshot_async(Callback<void(const JY_Snapshot&)> done){
+        return get_fields_async(JY_FIELD_ALL, done);
+    }
+
+    /** 
+     * get_acceleration_async
+     * @bref start non-blocking read of 3axis acceleration.
+    */
+    int get_acceleration_async(Callback<void(JY_Dim_3D)> done){
+        return start_async_dim(JY_FIELD_ACCELERATION, done);
+    }
+
+    /** 
+     * get_angular_velocity_async
+     * @bref start non-blocking read of 3axis angular velocity.
+    */
+    int get_angular_velocity_async(Callback<void(JY_Dim_3D)> done){
+        return start_async_dim(JY_FIELD_ANGULAR_VELOCITY, done);
+    }
+
+    /** 
+     * get_magnetic_async
+     * @bref start non-blocking read of 3axis magnetic.
+    */
+    int get_magnetic_async(Callback<void(JY_Dim_3D)> done){
+        return start_async_dim(JY_FIELD_MAGNETIC, done);
+    }
+
+    /** 
+     * get_pitch_angle_async
+     * @bref start non-blocking read of pitch angle.
+    */
+    int get_pitch_angle_async(Callback<void(JY_Pitch_Angle)> done){
+        if(async_busy) return -1;
+        async_field    = JY_FIELD_ANGLE;
+        async_angle_cb = done;
+        return start_async(JY_FIELD_ANGLE);
+    }
+
+    /** 
+     * get_quaternion_async
+     * @bref start non-blocking read of quaternion.
+    */
+    int get_quaternion_async(Callback<void(JY_Quaternion)> done){
+        if(async_busy) return -1;
+        async_field         = JY_FIELD_QUATERNION;
+        async_quaternion_cb = done;
+        return start_async(JY_FIELD_QUATERNION);
+    }
+
+    /** 
+     * attach_async_error
+     * @bref set callback called with I2C_EVENT_* flags when an async read failed.
+    */
+    void attach_async_error(Callback<void(int)> error){
+        async_error_cb = error;
+    }
+
+    /** 
+     * is_async_busy
+     * @return true while an async read is running.
+    */
+    bool is_async_busy(void) const {
+        return async_busy;
+    }
+#endif
+
+    /** 
+     * set_read_merge_gap
+     * @bref set how many unused registers get_fields may read through to save a transaction.
+    */
+    void set_read_merge_gap(int merge_gap_regs){
+        plan.set_merge_gap(merge_gap_regs);
+    }
+
+    /** 
+     * decode_snapshot
+     * @bref decode a raw 0x30 - 0x54 register block.
+     * @param buff       : JY_SNAPSHOT_BYTES bytes read from JY_SNAPSHOT_ADDR.
+     * @param ret        : destination.
+     * @param field_mask : fields to decode. The others are left untouched.
+    */
+    static void decode_snapshot(const char *buff, JY_Snapshot *ret, unsigned int field_mask = JY_FIELD_ALL){
+        using namespace JY901_Reg;
+        const int base = JY_SNAPSHOT_ADDR;
+        if(field_mask & JY_FIELD_TIME){
+            decode_time(buff, base, &ret->time);
+        }
+        if(field_mask & JY_FIELD_TEMPERTURE){
+            ret->temperture            = TEMP::value_at(buff, base);
+            ret->acceleration.temp     = ret->temperture;
+            ret->angular_velocity.temp = ret->temperture;
+            ret->magnetic.temp         = ret->temperture;
+        }
+        if(field_mask & JY_FIELD_ACCELERATION){
+            ret->acceleration.x        = ACC_X::value_at(buff, base);
+            ret->acceleration.y        = ACC_Y::value_at(buff, base);
+            ret->acceleration.z        = ACC_Z::value_at(buff, base);
+        }
+        if(field_mask & JY_FIELD_ANGULAR_VELOCITY){
+            ret->angular_velocity.x    = GYRO_X::value_at(buff, base);
+            ret->angular_velocity.y    = GYRO_Y::value_at(buff, base);
+            ret->angular_velocity.z    = GYRO_Z::value_at(buff, base);
+        }
+        if(field_mask & JY_FIELD_MAGNETIC){
+            ret->magnetic.x            = MAG_X::value_at(buff, base);
+            ret->magnetic.y            = MAG_Y::value_at(buff, base);
+            ret->magnetic.z            = MAG_Z::value_at(buff, base);
+        }
+        if(field_mask & JY_FIELD_ANGLE){
+            ret->angle.roll            = ROLL::value_at(buff, base);
+            ret->angle.pitch           = PITCH::value_at(buff, base);
+            ret->angle.yow             = YOW::value_at(buff, base);
+        }
+        if(field_mask & JY_FIELD_PIN_STATUS){
+            decode_pin_status(buff, base, &ret->pin_status);
+        }
+        if(field_mask & JY_FIELD_PRESSURE_HEIGHT){
+            ret->pressure_height.pressure = PRESSURE::value_at(buff, base);
+            ret->pressure_height.height   = HEIGHT::value_at(buff, base);
+        }
+        if(field_mask & JY_FIELD_POSITION){
+            ret->position.longitude       = LON::value_at(buff, base);
+            ret->position.latitude        = LAT::value_at(buff, base);
+        }
+        if(field_mask & JY_FIELD_QUATERNION){
+            ret->quaternion.quat0      = Q0::value_at(buff, base);
+            ret->quaternion.quat1      = Q1::value_at(buff, base);
+            ret->quaternion.quat2      = Q2::value_at(buff, base);
+            ret->quaternion.quat3      = Q3::value_at(buff, base);
+        }
+    }
+
+    /** 
+     * copy_fields
+     * @bref copy selected fields of a snapshot.
+     * @param field_mask : fields to copy. The others of ret are left untouched.
+    */
+    static void copy_fields(const JY_Snapshot &src, JY_Snapshot *ret, unsigned int field_mask){
+        if(field_mask & JY_FIELD_TIME)             ret->time             = src.time;
+        if(field_mask & JY_FIELD_ACCELERATION)     ret->acceleration     = src.acceleration;
+        if(field_mask & JY_FIELD_ANGULAR_VELOCITY) ret->angular_velocity = src.angular_velocity;
+        if(field_mask & JY_FIELD_MAGNETIC)         ret->magnetic         = src.magnetic;
+        if(field_mask & JY_FIELD_ANGLE)            ret->angle            = src.angle;
+        if(field_mask & JY_FIELD_TEMPERTURE)       ret->temperture       = src.temperture;
+        if(field_mask & JY_FIELD_PIN_STATUS)       ret->pin_status       = src.pin_status;
+        if(field_mask & JY_FIELD_PRESSURE_HEIGHT)  ret->pressure_height  = src.pressure_height;
+        if(field_mask & JY_FIELD_POSITION)         ret->position         = src.position;
+        if(field_mask & JY_FIELD_QUATERNION)       ret->quaternion       = src.quaternion;
+    }
+
+    static void decode_time(const char *buff, int base, JY_Time *ret){
+        ret->year  = 2000 + JY901_Reg::YEAR::raw_at(buff, base);
+        ret->month = JY901_Reg::MONTH::raw_at(buff, base);
+        ret->day   = JY901_Reg::DAY::raw_at(buff, base);
+        ret->hour  = JY901_Reg::HOUR::raw_at(buff, base);
+        ret->min   = JY901_Reg::MIN::raw_at(buff, base);
+        ret->sec   = JY901_Reg::SEC::raw_at(buff, base);
+        ret->ms    = JY901_Reg::MS::raw_at(buff, base);
+    }
+
+    static void decode_pin_status(const char *buff, int base, JY_Pin_Status *ret){
+        ret->P0 = JY901_Reg::D0::raw_at(buff, base);
+        ret->P1 = JY901_Reg::D1::raw_at(buff, base);
+        ret->P2 = JY901_Reg::D2::raw_at(buff, base);
+        ret->P3 = JY901_Reg::D3::raw_at(buff, base);
+    }
+
 protected:
 
+#if DEVICE_I2C_ASYNCH
+    int start_async_dim(unsigned int field, Callback<void(JY_Dim_3D)> done){
+        if(async_busy) return -1;
+        async_field  = field;
+        async_dim_cb = done;
+        return start_async(field);
+    }
+
+    /* The plan merges every gap (async_plan is built with JY_SNAPSHOT_REGS),
+     * so the fields are one transfer. A second transfer can't be started from
+     * on_async_event: I2C::transfer locks the bus mutex, which is not allowed in interrupt context. */
+    int start_async(unsigned int field_mask){
+        async_plan.build(field_mask);
+        if(async_plan.get_count() != 1) return -1;
+        const JY901_Read_Plan::Range &r = async_plan.get_range(0);
+        async_busy = true;
+        if(this->read_async(r.addr, async_frame.at(r.addr), r.regs * 2,
+                            event_callback_t(this, &JY901_T::on_async_event))){
+            async_busy = false;
+            return -1;
+        }
+        return 0;
+    }
+
+    void on_async_event(int event){
+        if(event & (I2C_EVENT_ERROR | I2C_EVENT_ERROR_NO_SLAVE | I2C_EVENT_TRANSFER_EARLY_NACK)){
+            async_busy = false;
+            if(async_error_cb) async_error_cb(event);
+            return;
+        }
+        decode_snapshot(async_frame.data(), &async_snapshot, async_plan.get_mask());
+        if(mag_correction && (async_plan.get_mask() & JY_FIELD_MAGNETIC)) mag_correction->apply(&async_snapshot.magnetic);
+        async_busy = false;
+        switch(async_field){
+        case JY_FIELD_ACCELERATION:     async_dim_cb(async_snapshot.acceleration);     break;
+        case JY_FIELD_ANGULAR_VELOCITY: async_dim_cb(async_snapshot.angular_velocity); break;
+        case JY_FIELD_MAGNETIC:         async_dim_cb(async_snapshot.magnetic);         break;
+        case JY_FIELD_ANGLE:            async_angle_cb(async_snapshot.angle);          break;
+        case JY_FIELD_QUATERNION:       async_quaternion_cb(async_snapshot.quaternion); break;
+        default:                        async_snapshot_cb(async_snapshot);             break;
+        }
+    }
+#endif
+
+    /* unsigned short array -> little endian register bytes */
+    static void pack_registers(char *dst, const unsigned short *src, int regs){
+        for(int i = 0; i < regs; i++){
+            dst[i * 2]     = src[i] & 0x00FF;
+            dst[i * 2 + 1] = src[i] >> 8;
+        }
+    }
+
+    /** write_config
+     * @bref write one configuration register through the shadow.
+     * @return true if written, false if the register already had the value
+     *         or the write was not acknowledged (the shadow is left as it was).
+     */
+    bool write_config(char reg, unsigned short value, bool force = false){
+        MBED_ASSERT(reg >= 0 && reg < JY_CONFIG_REGS);
+        if(reg < 0 || reg >= JY_CONFIG_REGS) return false;
+        unsigned long bit = 1ul << reg;
+        if(!force && (shadow_valid & bit) && shadow[(int)reg] == value) return false;
+        char dum[2];
+        pack_registers(dum, &value, 1);
+        if(this->write(reg, dum, 2)) return false;
+        shadow[(int)reg] = value;
+        shadow_valid |= bit;
+        return true;
+    }
+
+    /** write_config_block
+     * @bref write contiguous configuration registers through the shadow.
+     * @param tx : when given, the burst is queued to tx instead of sent at once.
+     * @remarks Only the range from first to last changed register is written, in one burst.
+     * @return true if written. false if not acknowledged, unless queued to tx.
+     */
+    bool write_config_block(char reg, const unsigned short *values, int regs,
+                            typename MyI2C_T<Bus>::Transaction *tx = 0){
+        MBED_ASSERT(reg >= 0 && regs >= 0 && reg + regs <= JY_CONFIG_REGS);
+        if(reg < 0 || regs < 0 || reg + regs > JY_CONFIG_REGS) return false;
+        int first = -1, last = -1;
+        for(int i = 0; i < regs; i++){
+            unsigned long bit = 1ul << (reg + i);
+            if((shadow_valid & bit) && shadow[reg + i] == values[i]) continue;
+            if(first < 0) first = i;
+            last = i;
+        }
+        if(first < 0) return false;
+        char dum[JY_CONFIG_REGS * 2];
+        pack_registers(dum, &values[first], last - first + 1);
+        if(tx) tx->add((char)(reg + first), dum, (last - first + 1) * 2);
+        else if(this->write((char)(reg + first), dum, (last - first + 1) * 2)) return false;
+        for(int i = first; i <= last; i++){
+            shadow[reg + i] = values[i];
+            shadow_valid |= 1ul << (reg + i);
+        }
+        return true;
+    }
+
+    /* blocking API, switches mode even while a calibration runs */
+    void enter_carlibration(JY_Calibration_Mode mode, int interval_ms){
+        cal_state = JY_CAL_IDLE;
+        start_carlibration(mode);
+        if(interval_ms){
+            wait_ms(interval_ms);
+            exit_carlibration();
+        }
+    }
+
+    /* CALSW is a command register, bypass the shadow */
+    void write_carlibration(JY_Calibration_Mode mode){
+        write_config(0x01, (unsigned short)mode, true);
+    }
+
+    void request_save(void){
+        settings_dirty = true;
+        if(!defer_save) commit_settings();
+    }
+
     void save_settings(void){
         char cmd[2] = {0x00, 0x00};
         this->write(0x00, cmd, 2);
     }
     unsigned short periods[4];
+    JY_Sampling_Rate return_rate = RATE_DEFAULT;
+    uint32_t single_latency = 0;
+    uint32_t single_latency_max = 0;
+    const JY_Mag_Correction *mag_correction = 0;
+    JY_Calibration_State cal_state = JY_CAL_IDLE;
+    JY_Calibration_Mode cal_mode = JY_CAL_NONE;
+    uint32_t cal_start = 0;
+    uint32_t cal_duration_us = 0;
+    unsigned short shadow[JY_CONFIG_REGS];
+    unsigned long shadow_valid = 0;
+    bool settings_dirty = false;
+    bool defer_save = false;
+    JY901_Read_Plan plan;
+#if DEVICE_I2C_ASYNCH
+    JY901_Read_Plan async_plan = JY901_Read_Plan(JY_SNAPSHOT_REGS);
+    volatile bool async_busy = false;
+    unsigned int async_field;
+    JY901_Frame async_frame;
+    JY_Snapshot async_snapshot;
+    Callback<void(const JY_Snapshot&)> async_snapshot_cb;
+    Callback<void(JY_Dim_3D)>          async_dim_cb;
+    Callback<void(JY_Pitch_Angle)>     async_angle_cb;
+    Callback<void(JY_Quaternion)>      async_quaternion_cb;
+    Callback<void(int)>                async_error_cb;
+#endif
 };
 
-#include "jy901-gps.hpp"
\ No newline at end of file
+typedef JY901_T<I2C> JY901;
+
+#include "jy901-gps.hpp"
+#ifdef JY901_SERIAL
+#include "jy901-serial.hpp"
+#endif
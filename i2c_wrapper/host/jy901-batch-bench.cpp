@@ -0,0 +1,105 @@
+/** @file
+ *
+ * Host benchmark of JY901_Batch against the per-frame JY901_Frame accessors.
+ * Built by CMakeLists.txt in this directory. Build once per kernel and compare
+ * (EX cmake -DCMAKE_CXX_FLAGS=-mavx2 ...).
+ * Optional argument: number of frames (default 100000).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+#include "mbed.h"
+#include "jy901-batch.hpp"
+
+using namespace JY901_Type;
+
+static const int CHANNELS = sizeof(JY901_Batch_Output) / sizeof(float *);
+
+struct Channels
+{
+    std::vector<float> v[CHANNELS];
+    JY901_Batch_Output out;
+
+    Channels(size_t n){
+        float **p = (float **)&out;
+        for(int c = 0; c < CHANNELS; c++){
+            v[c].resize(n);
+            p[c] = v[c].data();
+        }
+    }
+};
+
+static double elapsed_ms(uint32_t from){
+    return (uint32_t)(us_ticker_read() - from) / 1000.0;
+}
+
+/* the per-frame path: what a caller does without JY901_Batch */
+static void decode_frames(const JY901_Frame *frames, size_t count, const JY901_Batch_Output &out){
+    for(size_t i = 0; i < count; i++){
+        JY_Dim_3D      a = frames[i].get_acceleration();
+        JY_Dim_3D      g = frames[i].get_angular_velocity();
+        JY_Dim_3D      m = frames[i].get_magnetic();
+        JY_Pitch_Angle e = frames[i].get_pitch_angle();
+        JY_Quaternion  q = frames[i].get_quaternion();
+        out.ax[i] = a.x;  out.ay[i] = a.y;  out.az[i] = a.z;
+        out.gx[i] = g.x;  out.gy[i] = g.y;  out.gz[i] = g.z;
+        out.mx[i] = m.x;  out.my[i] = m.y;  out.mz[i] = m.z;
+        out.roll[i] = e.roll;  out.pitch[i] = e.pitch;  out.yow[i] = e.yow;
+        out.temp[i] = a.temp;
+        out.q0[i] = q.quat0;  out.q1[i] = q.quat1;  out.q2[i] = q.quat2;  out.q3[i] = q.quat3;
+    }
+}
+
+/* number of values that differ more than float rounding */
+static size_t compare(const Channels &x, const Channels &y, size_t n){
+    size_t bad = 0;
+    for(int c = 0; c < CHANNELS; c++){
+        for(size_t i = 0; i < n; i++){
+            float d = fabsf(x.v[c][i] - y.v[c][i]);
+            if(d > 1e-6f * fabsf(y.v[c][i]) + 1e-6f) bad++;
+        }
+    }
+    return bad;
+}
+
+int main(int argc, char **argv){
+    size_t n = argc > 1 ? strtoul(argv[1], 0, 0) : 100000;
+#if defined(__AVX2__)
+    const char *kernel = "avx2";
+#else
+    const char *kernel = "scalar";
+#endif
+
+    std::vector<JY901_Frame> frames(n);
+    srand(1);
+    for(size_t i = 0; i < n; i++){
+        for(int b = 0; b < JY_SNAPSHOT_BYTES; b++) frames[i].data()[b] = (char)rand();
+    }
+    Channels batch(n), scalar(n), frame(n);
+
+    double t_batch = 1e9, t_scalar = 1e9, t_frame = 1e9;
+    for(int rep = 0; rep < 20; rep++){
+        uint32_t t = us_ticker_read();
+        JY901_Batch::decode(frames.data(), n, batch.out);
+        t_batch = fmin(t_batch, elapsed_ms(t));
+
+        t = us_ticker_read();
+        JY901_Batch::decode_scalar(frames.data(), n, scalar.out);
+        t_scalar = fmin(t_scalar, elapsed_ms(t));
+
+        t = us_ticker_read();
+        decode_frames(frames.data(), n, frame.out);
+        t_frame = fmin(t_frame, elapsed_ms(t));
+    }
+
+    size_t bad_scalar = compare(batch, scalar, n);
+    size_t bad_frame  = compare(batch, frame, n);
+    printf("%lu frames, kernel %s\n", (unsigned long)n, kernel);
+    printf("  decode        %9.3f ms %6.2f ns/frame\n", t_batch, t_batch * 1e6 / n);
+    printf("  decode_scalar %9.3f ms %6.2f ns/frame\n", t_scalar, t_scalar * 1e6 / n);
+    printf("  per frame     %9.3f ms %6.2f ns/frame\n", t_frame, t_frame * 1e6 / n);
+    printf("  mismatch: scalar %lu, per frame %lu\n", (unsigned long)bad_scalar, (unsigned long)bad_frame);
+    return bad_scalar || bad_frame ? 1 : 0;
+}
@@ -0,0 +1,80 @@
+/** @file
+ *
+ * Bus efficiency of the JY901 read strategies on SimI2C.
+ * Prints transactions, bytes and modeled bus time at 100k / 400k / 1MHz
+ * and fails when a strategy costs more transactions or bytes than expected.
+ */
+
+#include <stdio.h>
+#include "mbed.h"
+#include "jy901.hpp"
+#include "jy901-sim.hpp"
+
+static int failures = 0;
+
+typedef struct{
+    const char *name;
+    unsigned long transactions;
+    unsigned long bytes;
+} Expected;
+
+static void report(I2C *bus, const Expected &e){
+    printf("  %-30s %4lu tx %5lu bytes %9.1f us @100k %8.1f us @400k %8.1f us @1M\n",
+           e.name, bus->get_transactions(), bus->get_bytes(),
+           bus->get_bus_time_us(100000), bus->get_bus_time_us(400000), bus->get_bus_time_us(1000000));
+    if(bus->get_transactions() != e.transactions || bus->get_bytes() != e.bytes){
+        printf("FAIL %s: %lu tx %lu bytes, expected %lu tx %lu bytes\n", e.name,
+               bus->get_transactions(), bus->get_bytes(), e.transactions, e.bytes);
+        failures++;
+    }
+}
+
+/* every output the snapshot has, one getter each */
+static void read_getters(JY901 *imu){
+    imu->get_time();
+    imu->get_acceleration();
+    imu->get_angular_velocity();
+    imu->get_magnetic();
+    imu->get_pitch_angle();
+    imu->get_temperture();
+    imu->get_pin_status();
+    imu->get_pressure_height();
+    imu->get_quaternion();
+}
+
+int main(void){
+    I2C bus;
+    JY901_Sim sim;
+    bus.attach(JY_ADDR, &sim);
+    JY901 imu(&bus);
+    JY_Snapshot data;
+
+    static const Expected full[] = {
+        {"getters (all outputs)",          18, 67},
+        {"get_snapshot",                    2, 75},
+        {"get_fields(JY_FIELD_ALL)",        4, 68},
+    };
+    static const Expected attitude[] = {
+        {"getters (acc, gyro, angle)",      6, 21},
+        {"get_snapshot",                    2, 75},
+        {"get_fields(acc | gyro | angle)",  4, 20},
+    };
+    const unsigned int attitude_mask = JY_FIELD_ACCELERATION | JY_FIELD_ANGULAR_VELOCITY | JY_FIELD_ANGLE;
+
+    printf("full state\n");
+    bus.reset_stats(); read_getters(&imu);                       report(&bus, full[0]);
+    bus.reset_stats(); data = imu.get_snapshot();                report(&bus, full[1]);
+    bus.reset_stats(); imu.get_fields(JY_FIELD_ALL, &data);      report(&bus, full[2]);
+
+    printf("acceleration, angular velocity and angle\n");
+    bus.reset_stats();
+    imu.get_acceleration();
+    imu.get_angular_velocity();
+    imu.get_pitch_angle();
+    report(&bus, attitude[0]);
+    bus.reset_stats(); data = imu.get_snapshot();                report(&bus, attitude[1]);
+    bus.reset_stats(); imu.get_fields(attitude_mask, &data);     report(&bus, attitude[2]);
+
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
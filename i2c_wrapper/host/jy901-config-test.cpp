@@ -0,0 +1,136 @@
+/** @file
+ *
+ * Host test of the JY901 configuration shadow against JY901_Sim.
+ */
+
+#include <stdio.h>
+#include "mbed.h"
+#include "jy901.hpp"
+#include "jy901-sim.hpp"
+
+static int failures = 0;
+
+static void check(const char *name, long got, long expected){
+    if(got == expected) return;
+    printf("FAIL %s: %ld, expected %ld\n", name, got, expected);
+    failures++;
+}
+
+static void apply_config(JY901 *imu){
+    static const unsigned short widths[4] = {1000, 1100, 1200, 1300};
+    imu->set_return_rate(RATE_HZ100);
+    imu->set_pin_mode(0, JY_PWM_OUT);
+    imu->set_pin_write(2, 1);
+    imu->set_pwm_period(0, 20000);
+    imu->set_pwm_widths(widths);
+}
+
+/* re-applying the same configuration costs no bus write */
+static void test_unchanged_skipped(void){
+    I2C bus;
+    JY901_Sim sim;
+    bus.attach(JY_ADDR, &sim);
+    JY901 imu(&bus);
+
+    apply_config(&imu);
+    check("first apply writes", sim.get_write_count() > 0, 1);
+    check("rate register",  sim.get_register(0x03), RATE_HZ100);
+    check("width register", sim.get_register(0x15), 1300);
+
+    unsigned long writes = sim.get_write_count();
+    bus.reset_stats();
+    apply_config(&imu);
+    check("reapply register writes", sim.get_write_count() - writes, 0);
+    check("reapply transactions",    bus.get_transactions(), 0);
+
+    /* one changed width of the block: only that register goes out */
+    static const unsigned short widths[4] = {1000, 1100, 1250, 1300};
+    imu.set_pwm_widths(widths);
+    check("changed width writes", sim.get_write_count() - writes, 1);
+    check("changed width",        sim.get_register(0x14), 1250);
+
+    /* after invalidate_shadow the next call writes again */
+    writes = sim.get_write_count();
+    imu.invalidate_shadow();
+    imu.set_return_rate(RATE_HZ100);
+    check("write after invalidate", sim.get_write_count() - writes, 1);
+}
+
+/* deferred settings are saved with one SAVE */
+static void test_deferred_save(void){
+    I2C bus;
+    JY901_Sim sim;
+    bus.attach(JY_ADDR, &sim);
+    JY901 imu(&bus);
+
+    imu.defer_settings(true);
+    imu.set_led(false);
+    imu.set_serial_baudrate(GPS_115200);
+    imu.set_new_i2c_address(0x51);
+    check("no save while deferred", sim.get_save_count(), 0);
+    check("led register",     sim.get_register(0x1b), 0x01);
+    check("baud register",    sim.get_register(0x04), GPS_115200);
+    check("address register", sim.get_register(0x1a), 0x51);
+
+    check("commit saves", imu.commit_settings(), 1);
+    check("one save",     sim.get_save_count(), 1);
+    check("nothing left to commit", imu.commit_settings(), 0);
+    check("still one save",         sim.get_save_count(), 1);
+
+    /* unchanged values don't mark the settings dirty */
+    imu.set_led(false);
+    imu.set_new_i2c_address(0x51);
+    check("unchanged commit", imu.commit_settings(), 0);
+
+    /* without defer every change saves at once */
+    imu.defer_settings(false);
+    imu.set_led(true);
+    check("immediate save", sim.get_save_count(), 2);
+}
+
+/* pin numbers out of range write nothing */
+static void test_pin_range(void){
+    I2C bus;
+    JY901_Sim sim;
+    bus.attach(JY_ADDR, &sim);
+    JY901 imu(&bus);
+
+    imu.set_pin_mode(-1, JY_PWM_OUT);
+    imu.set_pin_write(-3, 1);
+    imu.set_pwm_width(-1, 500);
+    imu.set_pwm_period(-2, 500);
+    imu.set_pwm_power(-1, 0.5f);
+    imu.set_pin_mode(4, JY_PWM_OUT);
+    check("out of range writes", sim.get_write_count(), 0);
+}
+
+/* calibration durations longer than the 32bit micro sec ticker are rejected */
+static void test_carlibration_duration(void){
+    I2C bus;
+    JY901_Sim sim;
+    bus.attach(JY_ADDR, &sim);
+    JY901 imu(&bus);
+
+    check("too long rejected", imu.start_carlibration(JY_CAL_MAGNETIC, JY_CAL_MAX_DURATION_MS + 1), 0);
+    check("too long writes",   sim.get_write_count(), 0);
+    check("too long state",    imu.get_carlibration_state(), JY_CAL_IDLE);
+
+    check("longest accepted", imu.start_carlibration(JY_CAL_MAGNETIC, JY_CAL_MAX_DURATION_MS), 1);
+    check("longest running",  imu.poll_carlibration(), JY_CAL_RUNNING);
+    imu.cancel_carlibration();
+
+    check("short accepted", imu.start_carlibration(JY_CAL_GYRO_ACC, 5), 1);
+    check("mode register",  sim.get_register(0x01), JY_CAL_GYRO_ACC);
+    wait_ms(10);
+    check("short done",     imu.poll_carlibration(), JY_CAL_DONE);
+    check("mode cleared",   sim.get_register(0x01), JY_CAL_NONE);
+}
+
+int main(void){
+    test_unchanged_skipped();
+    test_deferred_save();
+    test_pin_range();
+    test_carlibration_duration();
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,113 @@
+/** @file
+ *
+ * Host test of JY901_Fresh_Reader against JY901_Sim with timed outputs.
+ * The sim clock registers run between outputs, so only the output registers tell a new output.
+ */
+
+#include <stdio.h>
+#include "mbed.h"
+#include "jy901.hpp"
+#include "jy901-sim.hpp"
+#include "jy901-fresh.hpp"
+
+using namespace JY901_Type;
+
+static int failures = 0;
+
+static void check(const char *name, bool ok, long got){
+    if(ok) return;
+    printf("FAIL %s: %ld\n", name, got);
+    failures++;
+}
+
+/* polling every 1 ms at 100Hz output: one burst per output, probes for the rest */
+static void test_read(void){
+    I2C bus;
+    JY901_Sim sim;
+    bus.attach(JY_ADDR, &sim);
+    JY901 imu(&bus);
+    imu.set_return_rate(RATE_HZ100);
+    sim.set_output_timing(10000, 0);
+    JY901_Fresh_Reader<> r(&imu, JY_FIELD_ACCELERATION);
+
+    JY_Snapshot d;
+    int fresh = 0, same = 0;
+    float prev = 0;
+    unsigned long first = sim.get_output_count();
+    uint32_t start = us_ticker_read();
+    while(us_ticker_read() - start < 500000){
+        if(r.read(&d)){
+            if(fresh && d.acceleration.x == prev) same++;
+            prev = d.acceleration.x;
+            fresh++;
+        }
+        wait_us(1000);
+    }
+    long outputs = sim.get_output_count() - first + 1;
+    printf("read: %d fresh of %ld outputs, %lu probes, %lu bursts\n", fresh, outputs, r.get_probes(), r.get_bursts());
+    check("one burst per output",  (long)r.get_bursts() == fresh, r.get_bursts());
+    check("every output seen",     fresh >= outputs - 1 && fresh <= outputs, fresh);
+    check("fresh data changed",    same == 0, same);
+    check("probes between bursts", r.get_probes() > 4 * r.get_bursts(), r.get_probes());
+}
+
+/* the clock keeps running without outputs: no burst after the first */
+static void test_clock_only(void){
+    I2C bus;
+    JY901_Sim sim;
+    bus.attach(JY_ADDR, &sim);
+    JY901 imu(&bus);
+    imu.set_return_rate(RATE_HZ100);
+    sim.set_output_timing(0, 0);
+    JY901_Fresh_Reader<> r(&imu, JY_FIELD_ACCELERATION);
+
+    JY_Snapshot d;
+    uint32_t start = us_ticker_read();
+    while(us_ticker_read() - start < 50000){
+        r.read(&d);
+        wait_us(2000);
+    }
+    check("running clock is not an output", r.get_bursts() == 1, r.get_bursts());
+}
+
+/* wait_and_read picks up every output shortly after the module made it */
+static void test_wait_and_read(void){
+    I2C bus;
+    JY901_Sim sim;
+    bus.attach(JY_ADDR, &sim);
+    JY901 imu(&bus);
+    imu.set_return_rate(RATE_HZ100);
+    sim.set_output_timing(10000, 0);
+    JY901_Fresh_Reader<> r(&imu, JY_FIELD_ACCELERATION);
+
+    JY_Snapshot d;
+    int n = 0, timeouts = 0, skipped = 0;
+    long latency = 0;
+    unsigned long seen = 0;
+    uint32_t start = us_ticker_read();
+    while(us_ticker_read() - start < 500000){
+        if(!r.wait_and_read(&d)){
+            timeouts++;
+            continue;
+        }
+        unsigned long k = sim.get_output_count();
+        if(seen && k > seen + 1) skipped += k - seen - 1;
+        seen = k;
+        /* the prediction settles within a few outputs */
+        if(++n > 10) latency += us_ticker_read() - sim.get_output_us();
+    }
+    latency /= n > 10 ? n - 10 : 1;
+    printf("wait_and_read: %d outputs, mean latency %ld us, guard %u us, %lu probes, %lu misses\n",
+           n, latency, r.get_guard_us(), r.get_probes(), r.get_misses());
+    check("no timeout",           timeouts == 0, timeouts);
+    check("at most one skipped",  skipped <= 1, skipped);
+    check("latency below period", latency < 5000, latency);
+}
+
+int main(void){
+    test_read();
+    test_clock_only();
+    test_wait_and_read();
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,204 @@
+/** @file
+ *
+ * Host round trip test of JY901_Log_Writer and JY901_Log_Reader.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include "mbed.h"
+#include "jy901-log.hpp"
+
+using namespace JY901_Type;
+
+static int failures = 0;
+
+static void check(const char *name, long got, long expected){
+    if(got == expected) return;
+    printf("FAIL %s: %ld, expected %ld\n", name, got, expected);
+    failures++;
+}
+
+static const unsigned int MASK  = JY_FIELD_ACCELERATION | JY_FIELD_ANGULAR_VELOCITY | JY_FIELD_ANGLE;
+static const int SAMPLES        = 200;
+/* samples per block, flushed by hand so block boundaries are known */
+static const int PER_BLOCK      = 8;
+static const unsigned long T0   = 1000000;
+static const unsigned long STEP = 5000;
+
+/* random walk of every output register */
+static std::vector<JY901_Frame> make_frames(void){
+    std::vector<JY901_Frame> frames(SAMPLES);
+    short s[JY_SNAPSHOT_REGS] = {0};
+    srand(1);
+    for(int i = 0; i < SAMPLES; i++){
+        for(int r = 0; r < JY_SNAPSHOT_REGS; r++){
+            s[r] += rand() % 401 - 200;
+            frames[i].data()[r * 2]     = s[r];
+            frames[i].data()[r * 2 + 1] = s[r] >> 8;
+        }
+    }
+    return frames;
+}
+
+static std::vector<char> file_bytes(FILE *fp){
+    fseek(fp, 0, SEEK_END);
+    std::vector<char> ret(ftell(fp));
+    fseek(fp, 0, SEEK_SET);
+    if(fread(ret.data(), 1, ret.size(), fp) != ret.size()) ret.clear();
+    return ret;
+}
+
+static std::vector<char> write_log(const std::vector<JY901_Frame> &frames){
+    FILE *fp = tmpfile();
+    {
+        JY901_Log_Writer w(fp, MASK);
+        for(int i = 0; i < SAMPLES; i++){
+            w.write(T0 + i * STEP, frames[i]);
+            if(i % PER_BLOCK == PER_BLOCK - 1) w.flush();
+        }
+        check("written blocks", w.get_written_blocks(), SAMPLES / PER_BLOCK);
+    }
+    std::vector<char> ret = file_bytes(fp);
+    fclose(fp);
+    return ret;
+}
+
+/* read every sample, check each against the frame its timestamp belongs to.
+ * @return number of samples read */
+static int read_all(JY901_Log_Reader *r, const std::vector<JY901_Frame> &frames, const char *name){
+    char regs[JY_SNAPSHOT_REGS];
+    int nregs = JY901_Log::register_list(MASK, regs);
+    JY901_Frame f;
+    memset(f.data(), 0x5a, JY_SNAPSHOT_BYTES);
+    unsigned long ts;
+    int n = 0, bad = 0, untouched = 0;
+    while(r->read(&ts, &f)){
+        long i = (long)((ts - T0) / STEP);
+        if(ts < T0 || (ts - T0) % STEP || i >= SAMPLES){
+            bad++;
+            continue;
+        }
+        for(int k = 0; k < nregs; k++){
+            if(memcmp(f.at(regs[k]), frames[i].at(regs[k]), 2)) bad++;
+        }
+        if(f.at(JY901_Reg::Q0::addr)[0] != 0x5a) untouched++;
+        n++;
+    }
+    check(name, bad, 0);
+    check("registers out of mask untouched", untouched, 0);
+    return n;
+}
+
+static FILE *to_file(const std::vector<char> &log){
+    FILE *fp = tmpfile();
+    fwrite(log.data(), 1, log.size(), fp);
+    fflush(fp);
+    return fp;
+}
+
+/* offset of the n-th block header */
+static size_t block_offset(const std::vector<char> &log, int n){
+    for(size_t i = 0; i + 4 <= log.size(); i++){
+        if(JY901_Log::is_magic(&log[i]) && n-- == 0) return i;
+    }
+    return 0;
+}
+
+/* every sample comes back identical, from memory and from a file */
+static void test_round_trip(void){
+    std::vector<JY901_Frame> frames = make_frames();
+    std::vector<char> log = write_log(frames);
+
+    JY901_Log_Reader m(log.data(), log.size());
+    check("memory samples", read_all(&m, frames, "memory mismatch"), SAMPLES);
+    check("memory bad blocks", m.get_bad_blocks(), 0);
+    check("field mask", m.get_field_mask(), MASK);
+
+    FILE *fp = to_file(log);
+    JY901_Log_Reader f(fp);
+    check("file samples", read_all(&f, frames, "file mismatch"), SAMPLES);
+    check("file bad blocks", f.get_bad_blocks(), 0);
+
+    /* reset rewinds */
+    f.reset();
+    check("samples after reset", read_all(&f, frames, "mismatch after reset"), SAMPLES);
+    fclose(fp);
+}
+
+/* a torn last block is skipped, the blocks before it are read */
+static void test_truncated(void){
+    std::vector<JY901_Frame> frames = make_frames();
+    std::vector<char> log = write_log(frames);
+    log.resize(log.size() - 10);
+
+    JY901_Log_Reader m(log.data(), log.size());
+    check("truncated samples", read_all(&m, frames, "truncated mismatch"), SAMPLES - PER_BLOCK);
+    check("truncated bad blocks", m.get_bad_blocks(), 1);
+
+    FILE *fp = to_file(log);
+    JY901_Log_Reader f(fp);
+    check("truncated file samples", read_all(&f, frames, "truncated file mismatch"), SAMPLES - PER_BLOCK);
+    check("truncated file bad blocks", f.get_bad_blocks(), 1);
+    fclose(fp);
+}
+
+/* a flipped byte fails the crc of its block, the reader resyncs on the next magic.
+ * Leading garbage longer than a read window is skipped too. */
+static void test_corrupt(void){
+    std::vector<JY901_Frame> frames = make_frames();
+    std::vector<char> log = write_log(frames);
+    log[block_offset(log, 10) + JY901_LOG_HEADER + 5] ^= 0x55;
+    std::vector<char> garbage(3 * JY901_LOG_BLOCK + 7, 'J');
+    log.insert(log.begin(), garbage.begin(), garbage.end());
+
+    JY901_Log_Reader m(log.data(), log.size());
+    check("corrupt samples", read_all(&m, frames, "corrupt mismatch"), SAMPLES - PER_BLOCK);
+    check("corrupt bad blocks", m.get_bad_blocks(), 1);
+
+    FILE *fp = to_file(log);
+    JY901_Log_Reader f(fp);
+    check("corrupt file samples", read_all(&f, frames, "corrupt file mismatch"), SAMPLES - PER_BLOCK);
+    check("corrupt file bad blocks", f.get_bad_blocks(), 1);
+    fclose(fp);
+}
+
+/* a block with a valid crc but a sample cut in the middle leaves the frame untouched */
+static void test_bad_varint(void){
+    char block[JY901_LOG_HEADER + 3];
+    const char payload[3] = {0x05, 0x02, 0x04};  /* timestamp delta and 2 of 4 ACC registers */
+    memcpy(block, "JYL1", 4);
+    JY901_Log::put_u16(&block[4], JY_FIELD_ACCELERATION);
+    JY901_Log::put_u16(&block[6], 1);
+    JY901_Log::put_u16(&block[8], sizeof(payload));
+    JY901_Log::put_u32(&block[10], T0);
+    memcpy(&block[JY901_LOG_HEADER], payload, sizeof(payload));
+    JY901_Log::put_u32(&block[14], JY901_Log::crc32(payload, sizeof(payload), JY901_Log::crc32(&block[4], 10)));
+
+    JY901_Frame f;
+    memset(f.data(), 0x5a, JY_SNAPSHOT_BYTES);
+    unsigned long ts = 0;
+    JY901_Log_Reader alone(block, sizeof(block));
+    check("bad varint read", alone.read(&ts, &f), 0);
+    check("bad varint bad blocks", alone.get_bad_blocks(), 1);
+    check("frame untouched", (unsigned char)f.at(JY901_Reg::ACC_X::addr)[0], 0x5a);
+
+    /* followed by good blocks */
+    std::vector<JY901_Frame> frames = make_frames();
+    std::vector<char> log(block, block + sizeof(block));
+    std::vector<char> good = write_log(frames);
+    log.insert(log.end(), good.begin(), good.end());
+    JY901_Log_Reader m(log.data(), log.size());
+    check("read after bad varint", m.read(&ts, &f), 1);
+    check("resynced timestamp", ts, T0);
+    check("resynced register", memcmp(f.at(JY901_Reg::ACC_X::addr), frames[0].at(JY901_Reg::ACC_X::addr), 2), 0);
+}
+
+int main(void){
+    test_round_trip();
+    test_truncated();
+    test_corrupt();
+    test_bad_varint();
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
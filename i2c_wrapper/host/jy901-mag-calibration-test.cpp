@@ -0,0 +1,135 @@
+/** @file
+ *
+ * Host test of JY901_Mag_Calibrator and JY_Mag_Correction against JY901_Sim.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "mbed.h"
+#include "jy901.hpp"
+#include "jy901-sim.hpp"
+
+using namespace JY901_Type;
+
+static int failures = 0;
+
+static void check(const char *name, bool ok, double got){
+    if(ok) return;
+    printf("FAIL %s: %f\n", name, got);
+    failures++;
+}
+
+static double rnd(void){
+    return rand() / (double)RAND_MAX * 2 - 1;
+}
+
+/* random direction, uniform on the sphere */
+static void direction(double v[3]){
+    double n;
+    do{
+        v[0] = rnd();  v[1] = rnd();  v[2] = rnd();
+        n = sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    }while(n < 0.1 || n > 1);
+    for(int i = 0; i < 3; i++) v[i] /= n;
+}
+
+/* hard iron offset and soft iron matrix of the simulated module */
+static const double SOFT[3][3] = {{1.2, 0.1, 0.05}, {0.1, 0.8, -0.08}, {0.05, -0.08, 1.05}};
+static const double OFFSET[3]  = {300, -150, 80};
+static const double FIELD      = 1000;
+
+/* distorted field, noise in raw counts */
+static void set_field(JY901_Sim *sim, const double v[3], double noise){
+    double m[3];
+    for(int a = 0; a < 3; a++){
+        m[a] = OFFSET[a] + rnd() * noise;
+        for(int b = 0; b < 3; b++) m[a] += SOFT[a][b] * v[b] * FIELD;
+    }
+    sim->set_magnetic((short)lround(m[0]), (short)lround(m[1]), (short)lround(m[2]));
+}
+
+/* 3000 noisy samples through the bus, solved every 100 samples like the doc example */
+static void test_fit(void){
+    I2C bus;
+    JY901_Sim sim;
+    bus.attach(JY_ADDR, &sim);
+    JY901 imu(&bus);
+    JY901_Mag_Calibrator cal(0.999f);
+    JY_Mag_Correction corr;
+    corr.reset();
+    imu.set_magnetic_correction(&corr);
+    srand(1);
+
+    /* a zero read before the module is ready must not set the normalization */
+    cal.add(0.0f, 0.0f, 0.0f);
+    cal.add(1.0f, 0.0f, 0.0f);
+    check("near zero samples skipped", cal.get_samples() == 0, cal.get_samples());
+
+    int solved = 0;
+    for(int i = 0; i < 3000; i++){
+        double v[3];
+        direction(v);
+        set_field(&sim, v, 2);
+        cal.add(imu.get_magnetic_raw());
+        if(i % 100 == 99) solved += cal.solve(&corr);
+    }
+    check("every solve succeeds", solved == 30, solved);
+    for(int i = 0; i < 3; i++) check("offset", fabs(corr.offset[i] - OFFSET[i]) < 0.1, corr.offset[i]);
+
+    /* corrected magnitude is the geometric mean radius (cbrt(det(SOFT)) * FIELD = 995.6),
+     * within the rounding of the raw registers */
+    double lo = 1e9, hi = 0;
+    for(int i = 0; i < 500; i++){
+        double v[3];
+        direction(v);
+        set_field(&sim, v, 0);
+        JY_Dim_3D m = imu.get_magnetic();
+        double r = sqrt(m.x * m.x + m.y * m.y + m.z * m.z);
+        lo = fmin(lo, r);
+        hi = fmax(hi, r);
+    }
+    check("min magnitude", lo >= 994.6, lo);
+    check("max magnitude", hi <= 996.5, hi);
+}
+
+/* rotation around one axis only doesn't span an ellipsoid */
+static void test_degenerate(void){
+    JY901_Mag_Calibrator cal;
+    JY_Mag_Correction corr;
+    corr.reset();
+    for(int i = 0; i < 200; i++) cal.add(cosf(i * 0.1f) * 500, sinf(i * 0.1f) * 500, 10.0f);
+    check("single axis solve fails", !cal.solve(&corr), 0);
+    check("correction untouched", corr.offset[0] == 0 && corr.matrix[0] == 1, corr.matrix[0]);
+
+    JY901_Mag_Calibrator few;
+    few.add(500.0f, 0.0f, 0.0f);
+    check("too few samples", !few.solve(&corr), 0);
+}
+
+/* apply: matrix * (raw - offset) */
+static void test_apply(void){
+    JY_Mag_Correction corr;
+    corr.reset();
+    JY_Dim_3D m;
+    m.x = 1;  m.y = 2;  m.z = 3;
+    corr.apply(&m);
+    check("identity", m.x == 1 && m.y == 2 && m.z == 3, m.x);
+
+    static const float matrix[9] = {2, 0, 0, 0, 0, 1, 0, -1, 0};
+    memcpy(corr.matrix, matrix, sizeof(matrix));
+    corr.offset[0] = 10;  corr.offset[1] = 20;  corr.offset[2] = 30;
+    m.x = 11;  m.y = 22;  m.z = 33;
+    corr.apply(&m);
+    check("apply x", m.x == 2,  m.x);
+    check("apply y", m.y == 3,  m.y);
+    check("apply z", m.z == -2, m.z);
+}
+
+int main(void){
+    test_fit();
+    test_degenerate();
+    test_apply();
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
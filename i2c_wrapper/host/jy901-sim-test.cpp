@@ -0,0 +1,60 @@
+/** @file
+ *
+ * Host test of JY901 decoding against JY901_Sim.
+ * Built and run by CMakeLists.txt in this directory (ctest).
+ */
+
+#include <stdio.h>
+#include "mbed.h"
+#include "jy901.hpp"
+#include "jy901-gps.hpp"
+#include "jy901-sim.hpp"
+
+static int failures = 0;
+
+static void check(const char *name, float got, float expected){
+    if(got == expected) return;
+    printf("FAIL %s: %f, expected %f\n", name, got, expected);
+    failures++;
+}
+
+/* 32bit registers (pressure, height, longitude, latitude) keep their sign */
+static void test_negative_32bit(void){
+    I2C bus;
+    JY901_Sim sim;
+    bus.attach(JY_ADDR, &sim);
+    JY901_GPS imu(&bus);
+
+    sim.set_pressure_height(-101325, -50);
+    sim.set_position(-100, -3540000);
+
+    JY_Snapshot s = imu.get_snapshot();
+    check("snapshot pressure",  s.pressure_height.pressure, -101325);
+    check("snapshot height",    s.pressure_height.height,   -50);
+    check("snapshot longitude", s.position.longitude,       -100);
+    check("snapshot latitude",  s.position.latitude,        -3540000);
+
+    JY_Snapshot f;
+    imu.get_fields(JY_FIELD_PRESSURE_HEIGHT | JY_FIELD_POSITION, &f);
+    check("fields height",    f.pressure_height.height, -50);
+    check("fields longitude", f.position.longitude,     -100);
+
+    JY_Pressure_Height ph = imu.get_pressure_height();
+    check("get_pressure_height pressure", ph.pressure, -101325);
+    check("get_pressure_height height",   ph.height,   -50);
+
+    JY_Geographical_Position pos = imu.get_geographical_position();
+    check("get_geographical_position longitude", pos.longitude, -100);
+    check("get_geographical_position latitude",  pos.latitude,  -3540000);
+
+    sim.set_position(0x7fffffffL, -0x7fffffffL - 1);
+    pos = imu.get_geographical_position();
+    check("max longitude", pos.longitude, 2147483647.0f);
+    check("min latitude",  pos.latitude,  -2147483648.0f);
+}
+
+int main(void){
+    test_negative_32bit();
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
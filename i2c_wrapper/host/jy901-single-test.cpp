@@ -0,0 +1,98 @@
+/** @file
+ *
+ * Host test of JY901::acquire_single against JY901_Sim with timed outputs.
+ */
+
+#include <stdio.h>
+#include "mbed.h"
+#include "jy901.hpp"
+#include "jy901-sim.hpp"
+
+using namespace JY901_Type;
+
+static int failures = 0;
+
+static void check(const char *name, bool ok, long got){
+    if(ok) return;
+    printf("FAIL %s: %ld\n", name, got);
+    failures++;
+}
+
+/* every call writes the trigger and waits for the output it caused */
+static void test_trigger(void){
+    I2C bus;
+    JY901_Sim sim;
+    bus.attach(JY_ADDR, &sim);
+    JY901 imu(&bus);
+    /* no periodic output, 3 ms from trigger to output */
+    sim.set_output_timing(0, 3000);
+    JY_Snapshot d;
+
+    for(int i = 0; i < 2; i++){
+        unsigned long writes  = sim.get_write_count();
+        unsigned long outputs = sim.get_output_count();
+        long latency = imu.acquire_single(JY_FIELD_ACCELERATION, &d);
+        check("trigger written",    sim.get_write_count() - writes == 1, sim.get_write_count() - writes);
+        check("rate register",      sim.get_register(0x03) == RATE_SINGLE, sim.get_register(0x03));
+        check("one output",         sim.get_output_count() - outputs == 1, sim.get_output_count() - outputs);
+        check("latency after conversion", latency >= 3000, latency);
+        check("latency within a poll",    latency < 3000 + 2000, latency);
+        check("data of the output", d.acceleration.x == JY_Scale_Acceleration::to_float((short)sim.get_output_count()),
+              (long)d.acceleration.x);
+        check("get_single_latency_us", (long)imu.get_single_latency_us() == latency, imu.get_single_latency_us());
+    }
+    check("return rate", imu.get_return_rate() == RATE_SINGLE, imu.get_return_rate());
+
+    /* the running clock alone doesn't end the wait */
+    sim.set_output_timing(0, 20000);
+    long latency = imu.acquire_single(JY_FIELD_ACCELERATION, &d);
+    check("slow conversion", latency >= 20000, latency);
+    check("max latency", (long)imu.get_single_latency_max_us() == latency, imu.get_single_latency_max_us());
+
+    /* max keeps the worst, last follows the latest */
+    sim.set_output_timing(0, 1000);
+    latency = imu.acquire_single(JY_FIELD_ACCELERATION, &d);
+    check("fast conversion",  latency >= 1000 && latency < 20000, latency);
+    check("max kept",         imu.get_single_latency_max_us() >= 20000, imu.get_single_latency_max_us());
+    check("last latency",     (long)imu.get_single_latency_us() == latency, imu.get_single_latency_us());
+}
+
+/* no output within timeout_us: -1, destination and latency untouched */
+static void test_timeout(void){
+    I2C bus;
+    JY901_Sim sim;
+    bus.attach(JY_ADDR, &sim);
+    JY901 imu(&bus);
+    sim.set_output_timing(0, 50000);
+    JY_Snapshot d;
+    memset(&d, 0, sizeof(d));
+
+    uint32_t start = us_ticker_read();
+    long latency = imu.acquire_single(JY_FIELD_ACCELERATION, &d, 10000);
+    uint32_t took = us_ticker_read() - start;
+    check("timeout",           latency == -1, latency);
+    check("timeout duration",  took >= 10000 && took < 40000, took);
+    check("data untouched",    d.acceleration.x == 0, (long)d.acceleration.x);
+    check("latency untouched", imu.get_single_latency_us() == 0, imu.get_single_latency_us());
+}
+
+/* trigger not acknowledged: -2 without waiting */
+static void test_nack(void){
+    I2C bus;
+    JY901 imu(&bus);
+    JY_Snapshot d;
+
+    uint32_t start = us_ticker_read();
+    long ret = imu.acquire_single(JY_FIELD_ACCELERATION, &d, 10000);
+    check("nack",               ret == -2, ret);
+    check("nack doesn't wait",  us_ticker_read() - start < 10000, us_ticker_read() - start);
+    check("rate not changed",   imu.get_return_rate() == RATE_DEFAULT, imu.get_return_rate());
+}
+
+int main(void){
+    test_trigger();
+    test_timeout();
+    test_nack();
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+/** @file
+ *
+ * Host (Linux) replacement of mbed.h.
+ * Add i2c_wrapper/host to the include path before mbed-os to build
+ * MyI2C / JY901 against SimI2C. Only what this library uses is provided.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <assert.h>
+#include "sim-i2c.hpp"
+
+typedef SimI2C I2C;
+
+#define MBED_ASSERT(expr) assert(expr)
+
+inline uint32_t us_ticker_read(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000000ull + ts.tv_nsec / 1000);
+}
+
+inline void wait_us(int us){
+    struct timespec ts;
+    ts.tv_sec  = us / 1000000;
+    ts.tv_nsec = (us % 1000000) * 1000L;
+    nanosleep(&ts, 0);
+}
+
+inline void wait_ms(int ms){
+    wait_us(ms * 1000);
+}
@@ -0,0 +1,150 @@
+/** @file
+ *
+ * Host test of MyI2C_T::Transaction merging, flushing and error counting.
+ */
+
+#include <stdio.h>
+#include "mbed.h"
+#include "my-i2c.hpp"
+#include "jy901.hpp"
+#include "jy901-gps.hpp"
+#include "jy901-sim.hpp"
+
+using namespace JY901_Type;
+
+static int failures = 0;
+
+static void check(const char *name, long got, long expected){
+    if(got == expected) return;
+    printf("FAIL %s: %ld, expected %ld\n", name, got, expected);
+    failures++;
+}
+
+/* a write continuing the previous whole registers goes in the same transfer */
+static void test_merge(void){
+    I2C bus;
+    JY901_Sim sim;
+    bus.attach(JY_ADDR, &sim);
+    MyI2C dev(&bus, JY_ADDR);
+    static const char a[2] = {0x11, 0x22}, b[2] = {0x33, 0x44};
+
+    {
+        MyI2C::Transaction tx(&dev);
+        tx.add(0x12, a, 2);
+        tx.add(0x13, b, 2);
+        check("nothing sent before flush", bus.get_transactions(), 0);
+        check("flush errors", tx.flush(), 0);
+    }
+    check("merged transactions", bus.get_transactions(), 1);
+    check("merged bytes",        bus.get_bytes(), 5);
+    check("first register",      sim.get_register(0x12), 0x2211);
+    check("second register",     sim.get_register(0x13), 0x4433);
+
+    /* odd length previous write or a gap in subaddress: separate transfers */
+    bus.reset_stats();
+    {
+        MyI2C::Transaction tx(&dev);
+        tx.add(0x16, a, 1);
+        tx.add(0x16, b, 2);
+        tx.add(0x18, a, 2);
+    }
+    check("unmerged transactions", bus.get_transactions(), 3);
+    check("unmerged register",     sim.get_register(0x18), 0x2211);
+
+    /* merging stops at MY_I2C_MAX_WRITE bytes */
+    bus.reset_stats();
+    {
+        MyI2C::Transaction tx(&dev);
+        for(int i = 0; i < MY_I2C_MAX_WRITE / 2 + 1; i++) tx.add((char)(0x20 + i), a, 2);
+    }
+    check("max write transactions", bus.get_transactions(), 2);
+    check("max write bytes",        bus.get_bytes(), 2 + MY_I2C_MAX_WRITE + 2);
+}
+
+/* a full queue is sent before the next write is taken */
+static void test_flush_on_full(void){
+    I2C bus;
+    JY901_Sim sim;
+    bus.attach(JY_ADDR, &sim);
+    MyI2C dev(&bus, JY_ADDR);
+    char data[14] = {0};
+
+    /* entry limit: 8 writes queued, the 9th flushes them */
+    {
+        MyI2C::Transaction tx(&dev);
+        for(int i = 0; i < 8; i++) tx.add((char)(0x20 + i * 2), data, 1);
+        check("8 entries queued", bus.get_transactions(), 0);
+        tx.add(0x40, data, 1);
+        check("9th entry flushes", bus.get_transactions(), 8);
+    }
+    check("destructor flushes", bus.get_transactions(), 9);
+
+    /* byte limit: three 15 byte writes fit in MY_I2C_TRANSACTION_BYTES, the 4th does not */
+    bus.reset_stats();
+    {
+        MyI2C::Transaction tx(&dev);
+        for(int i = 0; i < 3; i++) tx.add((char)(0x20 + i * 8), data, 14);
+        check("3 writes queued", bus.get_transactions(), 0);
+        tx.add(0x40, data, 14);
+        check("4th write flushes", bus.get_transactions(), 3);
+        tx.flush();
+    }
+    check("byte limit transactions", bus.get_transactions(), 4);
+
+    /* longer than MY_I2C_MAX_WRITE: queued writes first, then split by MyI2C_T::write */
+    bus.reset_stats();
+    {
+        char big[MY_I2C_MAX_WRITE + 4] = {0};
+        MyI2C::Transaction tx(&dev);
+        tx.add(0x10, data, 2);
+        tx.add(0x20, big, sizeof(big));
+        check("oversize transactions", bus.get_transactions(), 3);
+        check("oversize errors",       tx.get_errors(), 0);
+    }
+}
+
+/* writes not acknowledged are counted, also for oversize writes */
+static void test_errors(void){
+    I2C bus;
+    MyI2C dev(&bus, JY_ADDR);
+    char big[MY_I2C_MAX_WRITE + 4] = {0};
+
+    check("write error count",   dev.write(0x10, big, sizeof(big)), 2);
+    check("single write error",  dev.write(0x10, (char)1), 1);
+
+    MyI2C::Transaction tx(&dev);
+    tx.add(0x10, big, 2);
+    tx.add(0x20, big, 2);
+    check("flush errors",     tx.flush(), 2);
+    tx.add(0x10, big, sizeof(big));
+    check("oversize errors",  tx.get_errors(), 4);
+}
+
+/* JY901_GPS PWM setters: pin 0 and pin 2-3 as two back-to-back bursts */
+static void test_gps_pwm(void){
+    I2C bus;
+    JY901_Sim sim;
+    bus.attach(JY_ADDR, &sim);
+    JY901_GPS imu(&bus);
+    static const unsigned short widths[4] = {1000, 1100, 1200, 1300};
+
+    imu.set_pwm_widths(widths);
+    check("pwm transactions", bus.get_transactions(), 2);
+    check("pwm bytes",        bus.get_bytes(), 3 + 5);
+    check("pin 0 width",      sim.get_register(0x12), 1000);
+    check("pin 1 untouched",  sim.get_register(0x13), 0);
+    check("pin 3 width",      sim.get_register(0x15), 1300);
+
+    bus.reset_stats();
+    imu.set_pwm_widths(widths);
+    check("unchanged pwm transactions", bus.get_transactions(), 0);
+}
+
+int main(void){
+    test_merge();
+    test_flush_on_full();
+    test_errors();
+    test_gps_pwm();
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
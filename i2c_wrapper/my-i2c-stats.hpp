@@ -0,0 +1,200 @@
+#pragma once
+#include "mbed.h"
+
+/** @file
+ *
+ * Opt-in bus instrumentation.
+ * Define MY_I2C_STATS (EX -DMY_I2C_STATS) to time every MyI2C_T transfer and
+ * the JY901 getters. Without it the hooks below expand to nothing.
+ *
+ * Updates are not locked. Counters can be off by one when several threads
+ * share the bus and a query runs at the same time, which is fine for monitoring.
+ */
+
+#ifdef MY_I2C_STATS
+
+/* Registers having their own counters (subaddress 0 - MY_I2C_STATS_REGS - 1). */
+#ifndef MY_I2C_STATS_REGS
+#define MY_I2C_STATS_REGS 0x60
+#endif
+/* Number of APIs having their own histogram. */
+#ifndef MY_I2C_STATS_APIS
+#define MY_I2C_STATS_APIS 16
+#endif
+
+/** MyI2C_Histogram Class
+ * Latency histogram of power of 2 buckets in micro sec.
+ * Bucket 0 is 0us, bucket b is [2^(b-1), 2^b) us, the last one takes the rest.
+ */
+class MyI2C_Histogram
+{
+public:
+    static const int BUCKETS = 16;
+
+    MyI2C_Histogram(){ reset(); }
+
+    void record(uint32_t us){
+        int b = 0;
+        while(b < BUCKETS - 1 && (us >> b)) b++;
+        bucket[b]++;
+        count++;
+        total_us += us;
+        if(us > max_us) max_us = us;
+    }
+
+    void reset(void){
+        memset(bucket, 0, sizeof(bucket));
+        count = total_us = max_us = 0;
+    }
+
+    /** get_percentile_us
+    * @bref upper bound of the bucket holding the percentile.
+    * @param percent : 0 - 100.
+    */
+    uint32_t get_percentile_us(float percent) const {
+        uint32_t rank = (uint32_t)(count * percent / 100.0f);
+        uint32_t sum  = 0;
+        for(int b = 0; b < BUCKETS - 1; b++){
+            sum += bucket[b];
+            if(sum > rank) return b ? (1u << b) - 1 : 0;
+        }
+        return max_us;
+    }
+    uint32_t get_mean_us(void) const { return count ? total_us / count : 0; }
+
+    uint32_t bucket[BUCKETS];
+    uint32_t count;
+    uint32_t total_us;
+    uint32_t max_us;
+};
+
+/** MyI2C_Counter
+ * Transfers that started at one register.
+ */
+typedef struct{
+    uint32_t count;
+    uint32_t bytes;
+    uint32_t errors;
+    uint32_t total_us;
+    uint32_t max_us;
+} MyI2C_Counter;
+
+/** MyI2C_Stats Class
+ * Process wide statistics, shared by every MyI2C_T instance.
+ * EX
+ *   const MyI2C_Stats &s = MyI2C_Stats::get();
+ *   printf("%lu %lu\n", s.get_transactions(), s.get_latency().get_percentile_us(99));
+ */
+class MyI2C_Stats
+{
+public:
+    static MyI2C_Stats &get(void){
+        static MyI2C_Stats stats;
+        return stats;
+    }
+
+    /** record
+    * @bref count one register transfer.
+    * @param subaddr      : first register.
+    * @param bytes        : bytes on the bus (subaddress included).
+    * @param transactions : number of addressed transfers.
+    * @param error        : non 0 when any transfer was not acknowledged.
+    * @param us           : time from start to completion.
+    */
+    void record(char subaddr, int bytes, int transactions, int error, uint32_t us){
+        this->transactions += transactions;
+        this->bytes        += bytes;
+        if(error) errors++;
+        latency.record(us);
+        unsigned char reg = subaddr;
+        if(reg >= MY_I2C_STATS_REGS) return;
+        MyI2C_Counter &c = regs[reg];
+        c.count++;
+        c.bytes    += bytes;
+        c.total_us += us;
+        if(error) c.errors++;
+        if(us > c.max_us) c.max_us = us;
+    }
+
+    /** api_id
+    * @bref histogram index of an API name. name must stay valid (EX a string literal).
+    * @return -1 when the table is full.
+    */
+    int api_id(const char *name){
+        for(int i = 0; i < n_apis; i++) if(!strcmp(api_names[i], name)) return i;
+        if(n_apis >= MY_I2C_STATS_APIS) return -1;
+        api_names[n_apis] = name;
+        return n_apis++;
+    }
+    void record_api(int id, uint32_t us){
+        if(id >= 0) apis[id].record(us);
+    }
+
+    void reset(void){
+        transactions = bytes = errors = 0;
+        latency.reset();
+        memset(regs, 0, sizeof(regs));
+        for(int i = 0; i < MY_I2C_STATS_APIS; i++) apis[i].reset();
+    }
+
+    uint32_t get_transactions(void) const { return transactions; }
+    uint32_t get_bytes(void) const { return bytes; }
+    uint32_t get_errors(void) const { return errors; }
+    /** latency of every register transfer */
+    const MyI2C_Histogram &get_latency(void) const { return latency; }
+    /** counters of transfers starting at reg, 0 when reg is not tracked */
+    const MyI2C_Counter *get_register(char reg) const {
+        return (unsigned char)reg < MY_I2C_STATS_REGS ? &regs[(unsigned char)reg] : 0;
+    }
+    int get_api_count(void) const { return n_apis; }
+    const char *get_api_name(int id) const { return api_names[id]; }
+    const MyI2C_Histogram &get_api_latency(int id) const { return apis[id]; }
+
+private:
+    MyI2C_Stats(): n_apis(0) { reset(); }
+
+    uint32_t transactions;
+    uint32_t bytes;
+    uint32_t errors;
+    MyI2C_Histogram latency;
+    MyI2C_Counter regs[MY_I2C_STATS_REGS];
+    int n_apis;
+    const char *api_names[MY_I2C_STATS_APIS];
+    MyI2C_Histogram apis[MY_I2C_STATS_APIS];
+};
+
+/** MyI2C_Stats_Scope Class
+ * Records the lifetime of the scope into an API histogram.
+ */
+class MyI2C_Stats_Scope
+{
+public:
+    MyI2C_Stats_Scope(int id): id(id), start(us_ticker_read()) {}
+    ~MyI2C_Stats_Scope(){ MyI2C_Stats::get().record_api(id, us_ticker_read() - start); }
+private:
+    int id;
+    uint32_t start;
+};
+
+/* start timing a transfer of MyI2C_T dev */
+#define MY_I2C_STATS_BEGIN(dev) \
+    uint32_t my_i2c_stats_start = (dev)->last_start_us = us_ticker_read()
+/* finish timing. error is OR of the bus return values. */
+#define MY_I2C_STATS_END(dev, subaddr, bytes, transactions, error) \
+    do{ \
+        (dev)->last_end_us = us_ticker_read(); \
+        MyI2C_Stats::get().record(subaddr, bytes, transactions, error, \
+                                  (dev)->last_end_us - my_i2c_stats_start); \
+    }while(0)
+/* time the rest of the enclosing function as API name */
+#define MY_I2C_STATS_API(name) \
+    static const int my_i2c_stats_api = MyI2C_Stats::get().api_id(name); \
+    MyI2C_Stats_Scope my_i2c_stats_scope(my_i2c_stats_api)
+
+#else
+
+#define MY_I2C_STATS_BEGIN(dev)
+#define MY_I2C_STATS_END(dev, subaddr, bytes, transactions, error) ((void)(error))
+#define MY_I2C_STATS_API(name)
+
+#endif
@@ -0,0 +1,162 @@
+#pragma once
+#include "mbed.h"
+#include "my-i2c.hpp"
+
+/* How long a client blocks for a free queue slot before the transfer fails. */
+#ifndef MY_I2C_WORKER_TIMEOUT_MS
+#define MY_I2C_WORKER_TIMEOUT_MS 100
+#endif
+
+/** @file
+ *
+ * Per bus worker thread for sharing one I2C bus between RTOS threads.
+ *
+ * Usage:
+ *   MyI2C_Worker<> worker(&i2c);             // one per bus
+ *   MyI2C_Worker_Client<> client(&worker);  // one per thread
+ *   JY901_T<MyI2C_Worker_Client<> > imu(&client);
+ */
+
+/** MyI2C_Future Class
+ * Completion of one request. Owned by the caller, must live until wait returns.
+ */
+class MyI2C_Future
+{
+public:
+    MyI2C_Future(): result(0) {}
+
+    /** wait
+    * @bref block until the worker finished the request.
+    * @return 0 on success, non-zero if the device didn't acknowledge.
+    */
+    int wait(void){
+        flags.wait_any(1);
+        return result;
+    }
+
+    /** ready
+    * @return true if the request was finished. Doesn't block.
+    */
+    bool ready(void){
+        return flags.get() & 1;
+    }
+
+    void complete(int ret){
+        result = ret;
+        flags.set(1);
+    }
+
+private:
+    EventFlags flags;
+    volatile int result;
+};
+
+/** MyI2C_Worker Class
+ * Only this thread touches the bus. Requests from any thread are put in a
+ * fixed size RTOS mail queue (no lock on the caller side) and executed in order.
+ * Give the worker higher priority than its callers to avoid priority inversion.
+ * @param Bus : bus policy (EX mbed I2C).
+ * @param N   : queue length.
+ */
+template <class Bus = I2C, int N = 8>
+class MyI2C_Worker
+{
+public:
+    typedef struct{
+        int addr;
+        const char *tx;
+        int tx_len;
+        char *rx;
+        int rx_len;
+        MyI2C_Future *future;
+    } Request;
+
+    MyI2C_Worker(Bus *bus, osPriority priority = osPriorityAboveNormal, uint32_t stack_size = 768)
+        : i2c(bus), thread(priority, stack_size) {
+        thread.start(callback(this, &MyI2C_Worker::loop));
+    }
+
+    /** submit
+    * @bref queue a write (tx) then repeated start read (rx) transaction.
+    * @param addr   : 8bit address.
+    * @param future : completed when the transaction finished.
+    * @param timeout_ms : how long to block for a free queue slot, 0 to return at once.
+    * @return 0 if queued, -1 if the queue stayed full.
+    * @remarks tx and rx must stay valid until future completes.
+    * @remarks Don't pass a timeout from interrupt context.
+    */
+    int submit(int addr, const char *tx, int tx_len, char *rx, int rx_len, MyI2C_Future *future,
+               uint32_t timeout_ms = 0){
+        Request *r = mail.alloc_for(timeout_ms);
+        if(!r) return -1;
+        r->addr   = addr;
+        r->tx     = tx;
+        r->tx_len = tx_len;
+        r->rx     = rx;
+        r->rx_len = rx_len;
+        r->future = future;
+        mail.put(r);
+        return 0;
+    }
+
+private:
+    void loop(void){
+        for(;;){
+            osEvent evt = mail.get();
+            if(evt.status != osEventMail) continue;
+            Request *r = (Request *)evt.value.p;
+            int ret = 0;
+            if(r->tx_len) ret |= i2c->write(r->addr, r->tx, r->tx_len, r->rx_len > 0);
+            if(r->rx_len && !ret) ret |= i2c->read(r->addr | 1, r->rx, r->rx_len);
+            MyI2C_Future *f = r->future;
+            mail.free(r);
+            f->complete(ret);
+        }
+    }
+
+    Bus *i2c;
+    Mail<Request, N> mail;
+    Thread thread;
+};
+
+/** MyI2C_Worker_Client Class
+ * Bus policy for MyI2C_T / JY901_T that sends transactions through MyI2C_Worker.
+ * A write with repeated start is kept and sent together with the following read,
+ * so subaddress + read is never split by other threads.
+ * Use one client per thread.
+ * A transfer fails (returns -1) when the queue stays full for MY_I2C_WORKER_TIMEOUT_MS.
+ */
+template <class Bus = I2C, int N = 8>
+class MyI2C_Worker_Client
+{
+public:
+    MyI2C_Worker_Client(MyI2C_Worker<Bus, N> *w): worker(w), pending(0) {}
+
+    int write(int address, const char *data, int length, bool repeated = false){
+        if(repeated && length <= (int)sizeof(tx)){
+            memcpy(tx, data, length);
+            pending = length;
+            return 0;
+        }
+        pending = 0;
+        return run(address, data, length, 0, 0);
+    }
+
+    int read(int address, char *data, int length, bool repeated = false){
+        (void)repeated;
+        int n = pending;
+        pending = 0;
+        return run(address & ~1, tx, n, data, length);
+    }
+
+private:
+    int run(int address, const char *w, int w_len, char *r, int r_len){
+        MyI2C_Future f;
+        if(worker->submit(address, w, w_len, r, r_len, &f, MY_I2C_WORKER_TIMEOUT_MS)) return -1;
+        return f.wait();
+    }
+
+    MyI2C_Worker<Bus, N> *worker;
+    char tx[1 + MY_I2C_MAX_WRITE];
+    int pending;
+};
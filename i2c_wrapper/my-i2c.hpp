@@ -1,49 +1,206 @@
 #pragma once
 #include "mbed.h"
+#include "my-i2c-stats.hpp"
 
-class MyI2C
+/* Largest payload sent in one addressed write (subaddress not included). */
+#ifndef MY_I2C_MAX_WRITE
+#define MY_I2C_MAX_WRITE 16
+#endif
+/* Buffer size of MyI2C_T::Transaction. */
+#ifndef MY_I2C_TRANSACTION_BYTES
+#define MY_I2C_TRANSACTION_BYTES 48
+#endif
+
+/** MyI2C_T Class
+ * Register access over a bus policy.
+ * Bus is any class that has the member functions of mbed I2C used here
+ * (mbed I2C, SimI2C, ...). It is resolved at compile time, no virtual call.
+ */
+template <class Bus = I2C>
+class MyI2C_T
 {
 public:
-    MyI2C(I2C *bus);
-    MyI2C(I2C *bus,  char address);
+    MyI2C_T(Bus *bus);
+    MyI2C_T(Bus *bus,  char address);
     void set_address( char address);
-    void write( char subaddr,  char data);
-    void write( char subaddr,  char* cmd, int bytes);
+    int  write( char subaddr,  char data);
+    int  write( char subaddr,  const char* cmd, int bytes);
     char read( char subaddr);
     void read( char subaddr, char *buf, int bytes);
+#if DEVICE_I2C_ASYNCH
+    int read_async( char subaddr, char *buf, int bytes, const event_callback_t &callback);
+#endif
+#ifdef MY_I2C_STATS
+    /** us_ticker_read at start / completion of the last blocking transfer (EX age of a sample). */
+    uint32_t get_last_start_us(void) const { return last_start_us; }
+    uint32_t get_last_end_us(void) const { return last_end_us; }
+#endif
+
+    /** Transaction Class
+     * Queue of register writes sent back-to-back by flush.
+     * Each write is subaddress + payload in one addressed transfer,
+     * writes continuing the previous register are merged into it.
+     * Remaining writes are flushed by the destructor.
+     */
+    class Transaction
+    {
+    public:
+        Transaction(MyI2C_T *device): dev(device), used(0), n(0), errors(0) {}
+        ~Transaction(){ flush(); }
+
+        /** add
+        * @bref queue a register write. Flushes first when the buffer is full.
+        * @remarks A payload longer than MY_I2C_MAX_WRITE is sent at once by MyI2C_T::write.
+        */
+        void add( char subaddr, const char *data, int bytes){
+            if(bytes > MY_I2C_MAX_WRITE){
+                flush();
+                errors += dev->write(subaddr, data, bytes);
+                return;
+            }
+            if(n){
+                int  last     = n - 1;
+                char last_sub = buf[start[last]];
+                if(!(len[last] & 1) && subaddr == (char)(last_sub + len[last] / 2)
+                     && used + bytes <= MY_I2C_TRANSACTION_BYTES && len[last] + bytes <= MY_I2C_MAX_WRITE){
+                    memcpy(&buf[used], data, bytes);
+                    used      += bytes;
+                    len[last] += bytes;
+                    return;
+                }
+            }
+            if(used + 1 + bytes > MY_I2C_TRANSACTION_BYTES || n == MAX_ENTRIES) flush();
+            start[n]  = used;
+            len[n]    = bytes;
+            buf[used] = subaddr;
+            memcpy(&buf[used + 1], data, bytes);
+            used += 1 + bytes;
+            n++;
+        }
+        void add( char subaddr, char data){
+            add(subaddr, &data, 1);
+        }
+
+        /** flush
+        * @bref send all queued writes.
+        * @return number of writes that were not acknowledged.
+        */
+        int flush(void){
+            int ret = 0;
+            for(int i = 0; i < n; i++){
+                MY_I2C_STATS_BEGIN(dev);
+                int err = dev->i2c->write(dev->addr, &buf[start[i]], 1 + len[i]);
+                MY_I2C_STATS_END(dev, buf[start[i]], 1 + len[i], 1, err);
+                if(err) ret++;
+            }
+            errors += ret;
+            used = 0;
+            n    = 0;
+            return ret;
+        }
+
+        /** get_errors
+        * @bref number of writes not acknowledged since construction.
+        */
+        int get_errors(void) const { return errors; }
+
+    private:
+        static const int MAX_ENTRIES = 8;
+        MyI2C_T *dev;
+        char buf[MY_I2C_TRANSACTION_BYTES];
+        int  start[MAX_ENTRIES];
+        int  len[MAX_ENTRIES];
+        int  used;
+        int  n;
+        int  errors;
+    };
+
 private:
      char addr;
-    I2C *i2c;
+    Bus *i2c;
+#if DEVICE_I2C_ASYNCH
+    char async_subaddr;
+#endif
+#ifdef MY_I2C_STATS
+    uint32_t last_start_us;
+    uint32_t last_end_us;
+#endif
 };
 
-MyI2C::MyI2C(I2C *bus){
+typedef MyI2C_T<I2C> MyI2C;
+
+template <class Bus>
+MyI2C_T<Bus>::MyI2C_T(Bus *bus){
     i2c = bus;
+#ifdef MY_I2C_STATS
+    last_start_us = last_end_us = 0;
+#endif
 }
-MyI2C::MyI2C(I2C *bus,  char address){
+template <class Bus>
+MyI2C_T<Bus>::MyI2C_T(Bus *bus,  char address){
     i2c = bus;
     addr = address << 1;
+#ifdef MY_I2C_STATS
+    last_start_us = last_end_us = 0;
+#endif
 }
-void MyI2C::set_address( char address){
+template <class Bus>
+void MyI2C_T<Bus>::set_address( char address){
     addr = address << 1;
 }
-void MyI2C::write( char subaddr,  char data){
-    i2c->write(addr, &subaddr, 1, true);
-    i2c->write(data);
-    i2c->stop();
+/* returns 1 when the write was not acknowledged, 0 otherwise */
+template <class Bus>
+int MyI2C_T<Bus>::write( char subaddr,  char data){
+    char buf[2] = {subaddr, data};
+    MY_I2C_STATS_BEGIN(this);
+    int err = i2c->write(addr, buf, 2);
+    MY_I2C_STATS_END(this, subaddr, 2, 1, err);
+    return err ? 1 : 0;
 }
-void MyI2C::write( char subaddr,  char* cmd, int bytes){
-    i2c->write(addr, &subaddr, 1, true);
-    i2c->write(addr, cmd, bytes);
-
-
+/* subaddress and payload go in one addressed transfer.
+ * Payload longer than MY_I2C_MAX_WRITE is split at register (2 bytes) boundary.
+ * Returns the number of transfers that were not acknowledged. */
+template <class Bus>
+int MyI2C_T<Bus>::write( char subaddr,  const char* cmd, int bytes){
+    char buf[1 + MY_I2C_MAX_WRITE];
+    int ret = 0;
+    while(bytes > 0){
+        int n = bytes > MY_I2C_MAX_WRITE ? (MY_I2C_MAX_WRITE & ~1) : bytes;
+        buf[0] = subaddr;
+        memcpy(&buf[1], cmd, n);
+        MY_I2C_STATS_BEGIN(this);
+        int err = i2c->write(addr, buf, 1 + n);
+        MY_I2C_STATS_END(this, subaddr, 1 + n, 1, err);
+        if(err) ret++;
+        subaddr += n / 2;
+        cmd     += n;
+        bytes   -= n;
+    }
+    return ret;
+}
+template <class Bus>
+char MyI2C_T<Bus>::read( char subaddr){
+    char ret;
+    MY_I2C_STATS_BEGIN(this);
+    int err = i2c->write( addr,&subaddr, 1, true);
+    err |= i2c->read(addr | 1, &ret, 1);
+    MY_I2C_STATS_END(this, subaddr, 2, 1, err);
+    return ret;
+}
+template <class Bus>
+void MyI2C_T<Bus>::read( char subaddr,  char *buf, int bytes){
+    MY_I2C_STATS_BEGIN(this);
+    int err = i2c->write(addr,&subaddr, 1, true);
+    err |= i2c->read(addr | 1, buf, bytes);
+    MY_I2C_STATS_END(this, subaddr, 1 + bytes, 1, err);
 }
- char MyI2C::read( char subaddr){
-    char *ret;
-    i2c->write( addr,&subaddr, 1, true);
-    i2c->read(addr | 1, ret, 1);
-    return *ret;
+#if DEVICE_I2C_ASYNCH
+/* Non-blocking subaddress write + repeated start read.
+ * callback is called from interrupt context with I2C_EVENT_* flags.
+ * buf must stay valid until callback. Returns 0 on start, -1 when the bus is busy. */
+template <class Bus>
+int MyI2C_T<Bus>::read_async( char subaddr, char *buf, int bytes, const event_callback_t &callback){
+    async_subaddr = subaddr;
+    return i2c->transfer(addr, &async_subaddr, 1, buf, bytes, callback, I2C_EVENT_ALL, false);
 }
-void MyI2C::read( char subaddr,  char *buf, int bytes){
-    i2c->write(addr,&subaddr, 1, true);
-    i2c->read(addr | 1, buf, bytes);
-}
\ No newline at end of file
+#endif
@@ -0,0 +1,151 @@
+#pragma once
+
+/** @file
+ *
+ * Simulated I2C bus for host (Linux) builds.
+ * SimI2C has the same member functions as mbed I2C that MyI2C uses,
+ * and counts transactions, bytes and modeled bus time.
+ */
+
+/** SimI2C_Device Class
+ * Slave device connected to SimI2C.
+ */
+class SimI2C_Device
+{
+public:
+    virtual ~SimI2C_Device() {}
+    /** called for every byte master writes. first is true for the first byte after address. */
+    virtual void i2c_write(char data, bool first) = 0;
+    /** called for every byte master reads. */
+    virtual char i2c_read(void) = 0;
+};
+
+/** SimI2C Class
+ * Drop-in substitute of mbed I2C.
+ * Bus time is modeled as 1 bit for START / repeated START and STOP, 9 bits per byte (with ACK).
+ */
+class SimI2C
+{
+public:
+    static const int MAX_DEVICES = 8;
+
+    SimI2C(int sda = 0, int scl = 0): hz(100000), n_devices(0), open(0), opened(false) {
+        (void)sda; (void)scl;
+        reset_stats();
+    }
+
+    /** attach
+    * @bref connect device at 7bit address.
+    */
+    bool attach(char address, SimI2C_Device *device){
+        if(n_devices >= MAX_DEVICES) return false;
+        addrs[n_devices]   = address;
+        devices[n_devices] = device;
+        n_devices++;
+        return true;
+    }
+
+    void frequency(int frequency_hz){ hz = frequency_hz; }
+    int  get_frequency(void) const { return hz; }
+
+    /* mbed I2C compatible interface. address is 8bit (7bit << 1 | R/W). */
+    int write(int address, const char *data, int length, bool repeated = false){
+        SimI2C_Device *dev = begin(address);
+        if(!dev){
+            if(!repeated) stop();
+            return -1;
+        }
+        for(int i = 0; i < length; i++){
+            dev->i2c_write(data[i], i == 0);
+            count_byte();
+        }
+        if(!repeated) stop();
+        return 0;
+    }
+
+    int read(int address, char *data, int length, bool repeated = false){
+        SimI2C_Device *dev = begin(address);
+        if(!dev){
+            if(!repeated) stop();
+            return -1;
+        }
+        for(int i = 0; i < length; i++){
+            data[i] = dev->i2c_read();
+            count_byte();
+        }
+        if(!repeated) stop();
+        return 0;
+    }
+
+    /* single byte write after a repeated=true transfer. returns 1 on ACK. */
+    int write(int data){
+        count_byte();
+        if(!open) return 0;
+        open->i2c_write((char)data, false);
+        return 1;
+    }
+
+    int read(int ack){
+        (void)ack;
+        count_byte();
+        return open ? (unsigned char)open->i2c_read() : 0xFF;
+    }
+
+    void start(void){
+        bits += 1;
+    }
+
+    void stop(void){
+        if(opened) bits += 1;
+        open   = 0;
+        opened = false;
+    }
+
+    /* statistics */
+    unsigned long get_transactions(void) const { return transactions; }
+    unsigned long get_bytes(void) const { return bytes; }
+    unsigned long get_nacks(void) const { return nacks; }
+    unsigned long get_bits(void) const { return bits; }
+    /** modeled bus time in micro sec at current frequency. */
+    double get_bus_time_us(void) const { return bits * 1e6 / hz; }
+    /** modeled bus time in micro sec at any frequency (EX 100000, 400000, 1000000). */
+    double get_bus_time_us(int frequency_hz) const { return bits * 1e6 / frequency_hz; }
+
+    void reset_stats(void){
+        transactions = 0;
+        bytes        = 0;
+        nacks        = 0;
+        bits         = 0;
+    }
+
+private:
+    SimI2C_Device *begin(int address){
+        bits += 1 + 9;
+        transactions++;
+        opened = true;
+        open   = 0;
+        for(int i = 0; i < n_devices; i++){
+            if(addrs[i] == (char)((address >> 1) & 0x7F)){
+                open = devices[i];
+                return open;
+            }
+        }
+        nacks++;
+        return 0;
+    }
+    void count_byte(void){
+        bits += 9;
+        bytes++;
+    }
+
+    int hz;
+    int n_devices;
+    char addrs[MAX_DEVICES];
+    SimI2C_Device *devices[MAX_DEVICES];
+    SimI2C_Device *open;
+    bool opened;
+    unsigned long transactions;
+    unsigned long bytes;
+    unsigned long nacks;
+    unsigned long bits;
+};